@@ -0,0 +1,131 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "arena.h"
+
+cVFDArena::cVFDArena() {
+  for(int i = 0; i < CLASSES; ++i)
+    blocks[i] = NULL;
+  nUsed = 0;
+  nReserved = 0;
+}
+
+cVFDArena::~cVFDArena() {
+  clear();
+}
+
+/** size class of a request, -1 if it's passed to malloc */
+int cVFDArena::Class(unsigned int n) {
+  unsigned int size = MIN_CHUNK;
+  for(int i = 0; i < CLASSES; ++i, size <<= 1) {
+    if(n <= size)
+      return i;
+  }
+  return -1;
+}
+
+unsigned int cVFDArena::Size(unsigned int n) {
+  int c = Class(n);
+  return c < 0 ? n : (MIN_CHUNK << c);
+}
+
+/** block of a chunk, blocks are aligned to their size */
+cVFDArena::tBlock* cVFDArena::Block(unsigned char* p) {
+  return (tBlock*) (((uintptr_t) p) & ~((uintptr_t) BLOCK_SIZE - 1));
+}
+
+unsigned char* cVFDArena::Alloc(unsigned int n) {
+  if(!n)
+    return NULL;
+  int c = Class(n);
+  if(c < 0) {
+    unsigned char* p = (unsigned char*) malloc(n);
+    if(p) {
+      nUsed += n;
+      nReserved += n;
+    }
+    return p;
+  }
+  const unsigned int size = MIN_CHUNK << c;
+  tBlock* b = blocks[c];
+  while(b && !b->free && b->nCarved == Capacity(c))
+    b = b->next;
+  if(!b) {
+    void* m = NULL;
+    if(posix_memalign(&m, BLOCK_SIZE, BLOCK_SIZE))
+      return NULL;
+    b = (tBlock*) m;
+    b->prev = NULL;
+    b->next = blocks[c];
+    if(b->next)
+      b->next->prev = b;
+    blocks[c] = b;
+    b->free = NULL;
+    b->nCarved = 0;
+    b->nLive = 0;
+    nReserved += BLOCK_SIZE;
+  }
+  unsigned char* p;
+  if(b->free) {
+    p = (unsigned char*) b->free;
+    b->free = b->free->next;
+  } else {
+    p = ((unsigned char*) b) + HEADER + (b->nCarved++ * size);
+  }
+  ++b->nLive;
+  nUsed += size;
+  return p;
+}
+
+void cVFDArena::Free(unsigned char* p, unsigned int n) {
+  if(!p)
+    return;
+  int c = Class(n);
+  if(c < 0) {
+    free(p);
+    nUsed -= n;
+    nReserved -= n;
+    return;
+  }
+  tBlock* b = Block(p);
+  tChunk* f = (tChunk*) p;
+  f->next = b->free;
+  b->free = f;
+  nUsed -= MIN_CHUNK << c;
+  if(--b->nLive == 0)
+    Release(c, b);
+}
+
+/** unlink a block of a class and return it to the system */
+void cVFDArena::Release(int c, tBlock* b) {
+  if(b->prev)
+    b->prev->next = b->next;
+  else
+    blocks[c] = b->next;
+  if(b->next)
+    b->next->prev = b->prev;
+  free(b);
+  nReserved -= BLOCK_SIZE;
+}
+
+void cVFDArena::clear() {
+  for(int c = 0; c < CLASSES; ++c) {
+    while(blocks[c]) {
+      nUsed -= blocks[c]->nLive * (MIN_CHUNK << c);
+      Release(c, blocks[c]);
+    }
+  }
+}
@@ -0,0 +1,63 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#ifndef __VFD_ARENA_H___
+#define __VFD_ARENA_H___
+
+#include <sys/types.h>
+
+/*
+ * Store of small bitmaps, e.g. glyphs. Each block holds chunks of one
+ * size class, a freed chunk is reused by the next request of its class.
+ * A block is released as soon as its last chunk is freed, so reserved
+ * memory shrinks with the used one. Requests above the largest class
+ * are passed to malloc().
+ */
+class cVFDArena {
+  enum { BLOCK_SIZE = 4096, MIN_CHUNK = 16, CLASSES = 6 }; // chunks of 16 ... 512 bytes
+  enum { HEADER = 64 };      ///< bytes in front of the first chunk of a block
+  struct tChunk {
+    tChunk* next;
+  };
+  struct tBlock {
+    tBlock* next;
+    tBlock* prev;
+    tChunk* free;            ///< returned chunks of this block
+    unsigned int nCarved;    ///< chunks, which were handed out once
+    unsigned int nLive;      ///< chunks, which are handed out now
+  };
+  typedef char HeaderCheck[(sizeof(tBlock) <= HEADER) ? 1 : -1];
+  tBlock* blocks[CLASSES];   ///< blocks of each class
+  unsigned long nUsed;       ///< bytes of chunks, which are handed out
+  unsigned long nReserved;   ///< bytes of blocks and large requests
+
+  static int Class(unsigned int n);
+  static unsigned int Capacity(int c) { return (BLOCK_SIZE - HEADER) / (MIN_CHUNK << c); }
+  static tBlock* Block(unsigned char* p);
+  void Release(int c, tBlock* b);
+public:
+  cVFDArena();
+  virtual ~cVFDArena();
+
+  unsigned char* Alloc(unsigned int n);
+  /** return a chunk, n must be the size of Alloc() */
+  void Free(unsigned char* p, unsigned int n);
+  /** release all blocks, chunks of large requests must be freed before */
+  void clear();
+  /** bytes, which a request of n occupies */
+  static unsigned int Size(unsigned int n);
+  unsigned long Used() const { return nUsed; }
+  unsigned long Reserved() const { return nReserved; }
+};
+
+#endif
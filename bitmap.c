@@ -24,10 +24,21 @@ cVFDBitmap::cVFDBitmap(int w, int h) {
   width = w;
   height = h;
 
-  // lines are byte aligned
-  bytesPerLine = (width + 7) / 8;
-  if(0<height && 0<bytesPerLine)
- 	  bitmap = MALLOC(uchar, bytesPerLine * height);
+  // columns are byte aligned, like RAM of display
+  bytesPerColumn = (height + 7) / 8;
+  bitmap = NULL;
+  damage = NULL;
+  if(0<width && 0<bytesPerColumn) {
+ 	  bitmap = MALLOC(uchar, bytesPerColumn * width);
+ 	  damage = MALLOC(uchar, width);
+  }
+  damaged = false;
+  inkMin = 0;
+  inkMax = width;
+  nClip = 0;
+  clip[0].x1 = clip[0].y1 = 0;
+  clip[0].x2 = width - 1;
+  clip[0].y2 = height - 1;
   clear();
 }
 
@@ -37,7 +48,14 @@ cVFDBitmap::cVFDBitmap(int w, int h) {
 cVFDBitmap::cVFDBitmap() {
   height = 0;
   width = 0;
+  bytesPerColumn = 0;
   bitmap = NULL;
+  damage = NULL;
+  damaged = false;
+  inkMin = inkMax = 0;
+  nClip = 0;
+  clip[0].x1 = clip[0].y1 = 0;
+  clip[0].x2 = clip[0].y2 = -1;
 }
 
 /**
@@ -48,6 +66,9 @@ cVFDBitmap::~cVFDBitmap() {
   if(bitmap)  
     free(bitmap);
   bitmap = NULL;
+  if(damage)  
+    free(damage);
+  damage = NULL;
 }
 
 /**
@@ -62,17 +83,32 @@ cVFDBitmap& cVFDBitmap::operator = (const cVFDBitmap& x) {
     if(bitmap)  
       free(bitmap);
     bitmap = NULL;
+    if(damage)  
+      free(damage);
+    damage = NULL;
 
     height = x.height;
     width  = x.width;
+    nClip = 0;
+    clip[0].x1 = clip[0].y1 = 0;
+    clip[0].x2 = width - 1;
+    clip[0].y2 = height - 1;
 
-    bytesPerLine = (width + 7) / 8;
+    bytesPerColumn = (height + 7) / 8;
 
-    if(0<height && 0<bytesPerLine)
-    	bitmap = MALLOC(uchar, bytesPerLine * height);
+    if(0<width && 0<bytesPerColumn) {
+    	bitmap = MALLOC(uchar, bytesPerColumn * width);
+    	damage = MALLOC(uchar, width);
+    }
   }
   if(bitmap && x.bitmap)
-  	memcpy(bitmap, x.bitmap, bytesPerLine * height);
+  	memcpy(bitmap, x.bitmap, bytesPerColumn * width);
+  nClip = x.nClip;
+  memcpy(clip, x.clip, sizeof(clip));
+  // whole contents replaced
+  inkMin = 0;
+  inkMax = width;
+  Damage(0, width);
   return *this;
 }
 
@@ -86,15 +122,73 @@ bool cVFDBitmap::operator == (const cVFDBitmap& x) const {
     || bitmap == NULL
     || x.bitmap == NULL)
     return false;
-	return ((memcmp(x.bitmap, bitmap, bytesPerLine * height)) == 0);
+	return ((memcmp(x.bitmap, bitmap, bytesPerColumn * width)) == 0);
 }
 
 /**
- * Cleanup current framebuffer. 
+ * Cleanup current framebuffer. Only columns, which were drawn
+ * since last clear, are damaged.
  */
 void cVFDBitmap::clear() {
     if (bitmap)
-      memset(bitmap, 0x00, bytesPerLine * height);
+      memset(bitmap, 0x00, bytesPerColumn * width);
+    Damage(inkMin, inkMax);
+    inkMin = width;
+    inkMax = 0;
+}
+
+void cVFDBitmap::Damage(int x1, int x2) {
+    x1 = max(x1, 0);
+    x2 = min(x2, width);
+    if (!damage || x1 >= x2)
+      return;
+    memset(damage + x1, 0x01, x2 - x1);
+    damaged = true;
+}
+
+void cVFDBitmap::ClearDamage() {
+    if (damage)
+      memset(damage, 0x00, width);
+    damaged = false;
+}
+
+void cVFDBitmap::CopyDamaged(const cVFDBitmap& x) {
+    if (!bitmap || !x.bitmap || !x.damage
+        || width != x.width || height != x.height)
+      return;
+    for (int c = 0; c < width; ++c) {
+      if (!x.damage[c])
+        continue;
+      memcpy(bitmap + (c * bytesPerColumn), x.bitmap + (c * bytesPerColumn), bytesPerColumn);
+      if (c < inkMin) inkMin = c;
+      if (c >= inkMax) inkMax = c + 1;
+    }
+}
+
+bool cVFDBitmap::SetColumn(int x, const uchar* col) {
+    if (!bitmap || x < 0 || x >= width)
+      return false;
+    uchar* dst = bitmap + (x * bytesPerColumn);
+    if (memcmp(dst, col, bytesPerColumn) == 0)
+      return false;
+    memcpy(dst, col, bytesPerColumn);
+    Ink(x, x + 1);
+    return true;
+}
+
+/**
+ * FNV-1a hash of all pixels.
+ */
+uint64_t cVFDBitmap::Hash() const {
+    uint64_t h = 14695981039346656037ULL;
+    if (bitmap) {
+      const unsigned int n = bytesPerColumn * width;
+      for (unsigned int i = 0; i < n; ++i) {
+        h ^= bitmap[i];
+        h *= 1099511628211ULL;
+      }
+    }
+    return h;
 }
 
 /**
@@ -111,58 +205,220 @@ bool cVFDBitmap::SetPixel(int x, int y)
     if (!bitmap)
         return false;
 
-    if (x >= width || x < 0)
+    const cVFDClip& r = clip[nClip];
+    if (x > r.x2 || x < r.x1)
         return false;
-    if (y >= height || y < 0)
+    if (y > r.y2 || y < r.y1)
         return false;
 
-    n = x + ((y / 8) * width);
+    n = (x * bytesPerColumn) + (y / 8);
     c = 0x80 >> (y % 8);
 
-    if(n >= (bytesPerLine * height))
+    if(n >= (bytesPerColumn * width))
         return false;
 
     bitmap[n] |= c;
+    damage[x] = 0x01;
+    damaged = true;
+    if (x < inkMin) inkMin = x;
+    if (x >= inkMax) inkMax = x + 1;
     return true;
 }
 
 
 /**
- * Draw a horizontal line on framebuffer. 
+ * Clip a rectangle to the current clip, corners are sorted.
  *
- * \param x1       First horizontal column.
- * \param y        vertical row.
- * \param x2       Second horizontal column.
+ * \return false, if nothing remain visible
  */
-bool cVFDBitmap::HLine(int x1, int y, int x2) {
+bool cVFDBitmap::ClipRect(int& x1, int& y1, int& x2, int& y2) {
 
     sort(x1,x2);
+    sort(y1,y2);
+
+    const cVFDClip& c = clip[nClip];
+    if (!bitmap || x2 < c.x1 || x1 > c.x2 || y2 < c.y1 || y1 > c.y2)
+        return false;
+    x1 = max(x1, c.x1);
+    y1 = max(y1, c.y1);
+    x2 = min(x2, c.x2);
+    y2 = min(y2, c.y2);
+    return true;
+}
+
+/**
+ * Restrict drawing to a rectangle. The new clip is the intersection
+ * with the current clip, it could be empty.
+ *
+ * \param x1       First horizontal corner (column).
+ * \param y1       First vertical corner (row).
+ * \param x2       Second horizontal corner (column).
+ * \param y2       Second vertical corner (row).
+ */
+bool cVFDBitmap::PushClip(int x1, int y1, int x2, int y2) {
+
+    if (nClip + 1 >= MAX_CLIP) {
+        esyslog("targaVFD: too many nested clip regions");
+        return false;
+    }
+    if (!ClipRect(x1, y1, x2, y2)) {
+        // nothing visible, empty region
+        x1 = y1 = 0;
+        x2 = y2 = -1;
+    }
+    ++nClip;
+    clip[nClip].x1 = x1;
+    clip[nClip].y1 = y1;
+    clip[nClip].x2 = x2;
+    clip[nClip].y2 = y2;
+    return x1 <= x2;
+}
+
+void cVFDBitmap::PopClip() {
+    if (nClip > 0)
+        --nClip;
+}
+
+/**
+ * Columns [x1, x2) was drawn, mark as damaged and extend the ink.
+ */
+void cVFDBitmap::Ink(int x1, int x2) {
+    Damage(x1, x2);
+    if (x1 < inkMin) inkMin = max(x1, 0);
+    if (x2 > inkMax) inkMax = min(x2, width);
+}
+
+/**
+ * Set, toggle or reset all pixels of a rectangle. Every byte of a column
+ * is written at once, only first and last byte need a mask of the edge.
+ *
+ * \param x1       First horizontal corner (column).
+ * \param y1       First vertical corner (row).
+ * \param x2       Second horizontal corner (column).
+ * \param y2       Second vertical corner (row).
+ * \param op       set, toggle or reset pixels.
+ */
+bool cVFDBitmap::Fill(int x1, int y1, int x2, int y2, eFill op) {
+
+    if (!ClipRect(x1, y1, x2, y2))
+        return false;
+
+    const int yb1 = y1 / 8;
+    const int yb2 = y2 / 8;
+    uchar top = 0xFF >> (y1 % 8);
+    uchar bottom = 0xFF << (7 - (y2 % 8));
+    if (yb1 == yb2)
+        top = bottom = top & bottom;
 
     for (int x = x1; x <= x2; x++) {
-        if(!SetPixel(x, y))
-          return false;
+        uchar* col = bitmap + (x * bytesPerColumn);
+        if (op == eFillInvert) {
+            col[yb1] ^= top;
+            for (int yb = yb1 + 1; yb < yb2; yb++)
+                col[yb] ^= 0xFF;
+            if (yb2 != yb1)
+                col[yb2] ^= bottom;
+        } else if (op == eFillErase) {
+            col[yb1] &= ~top;
+            for (int yb = yb1 + 1; yb < yb2; yb++)
+                col[yb] = 0x00;
+            if (yb2 != yb1)
+                col[yb2] &= ~bottom;
+        } else {
+            col[yb1] |= top;
+            for (int yb = yb1 + 1; yb < yb2; yb++)
+                col[yb] = 0xFF;
+            if (yb2 != yb1)
+                col[yb2] |= bottom;
+        }
     }
+    Ink(x1, x2 + 1);
     return true;
 }
 
 /**
- * Draw a vertical line on framebuffer. 
+ * Draw a monochrome image on framebuffer, pixels of image are or'ed.
  *
- * \param x        horizontal column.
- * \param y1       First vertical row.
- * \param y2       Second vertical row.
+ * \param x        horizontal column of left edge, may be outside.
+ * \param y        vertical row of top edge, may be outside.
+ * \param src      image, column by column with (h + 7) / 8 bytes, MSB is top row.
+ * \param w        columns of image.
+ * \param h        rows of image.
  */
-bool cVFDBitmap::VLine(int x, int y1, int y2) {
+bool cVFDBitmap::Blit(int x, int y, const uchar* src, int w, int h) {
 
-    sort(y1,y2);
+    if (!src || w <= 0 || h <= 0)
+        return false;
+    // visible part of image, whole columns and bytes outside are skipped
+    int x1 = x, y1 = y, x2 = x + w - 1, y2 = y + h - 1;
+    if (!ClipRect(x1, y1, x2, y2))
+        return false;
+
+    const int srcBytes = (h + 7) / 8;
+    const int shift = ((y % 8) + 8) % 8;
+    // first byte of column, which hold the top row of image
+    const int yb0 = (y - shift) / 8;
+    const int yb1 = y1 / 8;
+    const int yb2 = y2 / 8;
+    // bytes of source, which touch the visible rows
+    const int b1 = max(0, yb1 - yb0 - 1);
+    const int b2 = min(srcBytes - 1, yb2 - yb0);
+    uchar top = 0xFF >> (y1 % 8);
+    uchar bottom = 0xFF << (7 - (y2 % 8));
+    if (yb1 == yb2)
+        top = bottom = top & bottom;
 
-    for (int y = y1; y <= y2; y++) {
-        if(!SetPixel(x, y))
-          return false;
+    for (int c = x1 - x; c <= x2 - x; c++) {
+        const uchar* s = src + (c * srcBytes);
+        uchar* col = bitmap + ((x + c) * bytesPerColumn);
+        for (int b = b1; b <= b2; b++) {
+            const uchar v = s[b];
+            if (!v)
+                continue;
+            const int yb = yb0 + b;
+            if (yb >= yb1 && yb <= yb2)
+                col[yb] |= (v >> shift) & (yb == yb1 ? top : 0xFF) & (yb == yb2 ? bottom : 0xFF);
+            if (shift && yb + 1 >= yb1 && yb + 1 <= yb2)
+                col[yb + 1] |= (uchar)(v << (8 - shift)) & (yb + 1 == yb1 ? top : 0xFF) & (yb + 1 == yb2 ? bottom : 0xFF);
+        }
     }
+    Ink(x1, x2 + 1);
     return true;
 }
 
+/**
+ * Shift whole framebuffer horizontal in place, vacated columns are cleared.
+ *
+ * \param dx       columns to shift, positive to right, negative to left.
+ */
+void cVFDBitmap::Scroll(int dx) {
+
+    if (!bitmap || !dx || inkMin >= inkMax)
+        return;
+    if (dx >= width || -dx >= width) {
+        clear();
+        return;
+    }
+    const int n = width - abs(dx);
+    if (dx > 0) {
+        memmove(bitmap + (dx * bytesPerColumn), bitmap, n * bytesPerColumn);
+        memset(bitmap, 0x00, dx * bytesPerColumn);
+    } else {
+        memmove(bitmap, bitmap + (-dx * bytesPerColumn), n * bytesPerColumn);
+        memset(bitmap + (n * bytesPerColumn), 0x00, -dx * bytesPerColumn);
+    }
+    // old and new position of drawn columns are changed
+    const int x1 = max(inkMin + min(dx, 0), 0);
+    const int x2 = min(inkMax + max(dx, 0), width);
+    Damage(x1, x2);
+    inkMin = max(inkMin + dx, 0);
+    inkMax = min(inkMax + dx, width);
+    if (inkMin >= inkMax) {
+        inkMin = width;
+        inkMax = 0;
+    }
+}
+
 /**
  * Draw a rectangle on framebuffer. 
  *
@@ -174,19 +430,13 @@ bool cVFDBitmap::VLine(int x, int y1, int y2) {
  */
 bool cVFDBitmap::Rectangle(int x1, int y1, int x2, int y2, bool filled) {
 
-    if (!filled) {
-        return HLine(x1, y1, x2)
-            && VLine(x1, y1, y2)
-            && HLine(x1, y2, x2)
-            && VLine(x2, y1, y2);
-    } else {
-        sort(y1,y2);
+    if (filled)
+        return FillRect(x1, y1, x2, y2);
 
-        for (int y = y1; y <= y2; y++) {
-            if(!HLine(x1, y, x2))
-              return false;
-        }
-        return true;
-    }
+    // outline, each edge is a filled rectangle of one pixel
+    bool r = FillRect(x1, y1, x2, y1);
+    r = FillRect(x1, y2, x2, y2) || r;
+    r = FillRect(x1, y1, x1, y2) || r;
+    r = FillRect(x2, y1, x2, y2) || r;
+    return r;
 }
-
@@ -14,11 +14,33 @@
 #ifndef __VFD_BITMAP_H___
 #define __VFD_BITMAP_H___
 
+#include <stdint.h>
+
+/* visible region of drawing, corners are inclusive */
+struct cVFDClip {
+  int x1;
+  int y1;
+  int x2;
+  int y2;
+};
+
 class cVFDBitmap  {
+  enum { MAX_CLIP = 8 };
   int height;
   int width;
-  unsigned int bytesPerLine;
-  uchar *bitmap;
+  unsigned int bytesPerColumn;
+  uchar *bitmap;   ///< column by column, like RAM of display : x * bytesPerColumn + y / 8
+
+  /* damaged columns, since last ClearDamage() */
+  uchar *damage;
+  bool  damaged;
+  /* columns with drawn pixels, since last clear() */
+  int   inkMin;
+  int   inkMax;
+
+  /* stack of clip rectangles, first entry is whole framebuffer */
+  cVFDClip clip[MAX_CLIP];
+  int   nClip;
 protected:
   cVFDBitmap();
 
@@ -28,8 +50,10 @@ protected:
     x = y;
     y = t;
   };
-  bool HLine(int x1, int y, int x2);
-  bool VLine(int x, int y1, int y2);
+  bool ClipRect(int& x1, int& y1, int& x2, int& y2);
+  void Ink(int x1, int x2);
+  enum eFill { eFillSet, eFillInvert, eFillErase };
+  bool Fill(int x1, int y1, int x2, int y2, eFill op);
 public:
   cVFDBitmap(int w,int h);
   
@@ -43,8 +67,40 @@ public:
 
   bool SetPixel(int x, int y);
   bool Rectangle(int x1, int y1, int x2, int y2, bool filled);
+  /** set all pixels of rectangle, byte by byte */
+  bool FillRect(int x1, int y1, int x2, int y2) { return Fill(x1, y1, x2, y2, eFillSet); }
+  /** toggle all pixels of rectangle */
+  bool Invert(int x1, int y1, int x2, int y2) { return Fill(x1, y1, x2, y2, eFillInvert); }
+  /** reset all pixels of rectangle */
+  bool Erase(int x1, int y1, int x2, int y2) { return Fill(x1, y1, x2, y2, eFillErase); }
+  bool Blit(int x, int y, const uchar* src, int w, int h);
+  void Scroll(int dx);
+
+  /** restrict all drawing to rectangle, within the current clip */
+  bool PushClip(int x1, int y1, int x2, int y2);
+  /** restore the clip of previous PushClip */
+  void PopClip();
+  /** drop all clips, whole framebuffer is visible */
+  void ResetClip() { nClip = 0; }
+  /** current visible region */
+  const cVFDClip& Clip() const { return clip[nClip]; }
 
   uchar * getBitmap() const { return bitmap; };
+  unsigned int BytesPerColumn() const { return bytesPerColumn; }
+
+  /** mark columns [x1, x2) as damaged */
+  void Damage(int x1, int x2);
+  /** true, if any column was drawn or cleared */
+  bool Damaged() const { return damaged; }
+  /** flag of each column, non zero if damaged */
+  const uchar * getDamage() const { return damage; };
+  void ClearDamage();
+  /** take the damaged columns of another framebuffer, e.g. after swap of buffers */
+  void CopyDamaged(const cVFDBitmap& x);
+  /** replace column x, damaged only if it differs */
+  bool SetColumn(int x, const uchar* col);
+  /** hash of all pixels, to detect an unchanged frame */
+  uint64_t Hash() const;
 };
 
 
@@ -0,0 +1,94 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#include <vdr/tools.h>
+#include "digits.h"
+#include "ffont.h"
+
+// digits first, they share the width of a cell
+const char* cVFDDigits::CHARS = "0123456789:.-/() ";
+
+cVFDDigits::cVFDDigits() {
+  for (int i = 0; i < CELLS; ++i)
+    cell[i] = NULL;
+}
+
+cVFDDigits::~cVFDDigits() {
+  Destroy();
+}
+
+void cVFDDigits::Destroy() {
+  for (int i = 0; i < CELLS; ++i) {
+    if (cell[i]) {
+      delete cell[i];
+      cell[i] = NULL;
+    }
+  }
+}
+
+/**
+ * Render all cells with a font.
+ */
+bool cVFDDigits::Create(const cVFDFont* pFont) {
+  Destroy();
+  if (!pFont || pFont->Height() <= 0)
+    return false;
+
+  int nDigit = 0;
+  for (int i = 0; i < 10; ++i)
+    nDigit = max(nDigit, pFont->Width((uint) CHARS[i]));
+
+  for (int i = 0; i < CELLS; ++i) {
+    char sz[2] = { CHARS[i], '\0' };
+    int w = pFont->Width((uint) CHARS[i]);
+    int nCell = i < 10 ? nDigit : w;
+    if (nCell <= 0) {
+      Destroy();
+      return false;
+    }
+    cell[i] = new cVFDBitmap(nCell, pFont->Height());
+    pFont->DrawText(cell[i], (nCell - w) / 2, 0, sz, 0);
+  }
+  return true;
+}
+
+int cVFDDigits::Index(char c) const {
+  const char* p = c ? strchr(CHARS, c) : NULL;
+  return p ? p - CHARS : -1;
+}
+
+bool cVFDDigits::Has(const char* s) const {
+  if (!s || !cell[0])
+    return false;
+  for (; *s; ++s)
+    if (Index(*s) < 0)
+      return false;
+  return true;
+}
+
+int cVFDDigits::Width(char c) const {
+  const cVFDBitmap* b = Cell(c);
+  return b ? b->Width() : 0;
+}
+
+int cVFDDigits::Width(const char* s) const {
+  int w = 0;
+  for (; s && *s; ++s)
+    w += Width(*s);
+  return w;
+}
+
+const cVFDBitmap* cVFDDigits::Cell(char c) const {
+  int i = Index(c);
+  return i < 0 ? NULL : cell[i];
+}
@@ -0,0 +1,45 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#ifndef __VFD_DIGITS_H___
+#define __VFD_DIGITS_H___
+
+#include "bitmap.h"
+
+class cVFDFont;
+
+/*
+ * Pre-rendered cells of digits and separators, e.g. of clock and replay
+ * time. All digits share the width of the widest one, so a changed digit
+ * is replaced by its cell, without a new layout of the string.
+ */
+class cVFDDigits {
+  enum { CELLS = 17 };
+  static const char* CHARS;
+  cVFDBitmap* cell[CELLS];
+  int Index(char c) const;
+public:
+  cVFDDigits();
+  virtual ~cVFDDigits();
+
+  bool Create(const cVFDFont* pFont);
+  void Destroy();
+
+  /** true, if each character of string has a cell */
+  bool Has(const char* s) const;
+  int Width(char c) const;
+  int Width(const char* s) const;
+  const cVFDBitmap* Cell(char c) const;
+};
+
+#endif
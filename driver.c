@@ -0,0 +1,43 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#include <vdr/tools.h>
+
+#include "setup.h"
+#include "driver.h"
+#include "mdm166a.h"
+
+cVFDDriver* cVFDDriver::Create(int nDriver) {
+  switch(nDriver) {
+    default:
+      esyslog("targaVFD: unknown driver %d, use Futaba MDM166A", nDriver);
+    case eDriver_MDM166A:
+      return new cVFDDriverMDM166A();
+    case eDriver_128x64:
+      return new cVFDDriverMDM166A(128, 64);
+    case eDriver_256x64:
+      return new cVFDDriverMDM166A(256, 64);
+  }
+}
+
+/**
+ * The whole RAM in writes of complete columns, ahead a reset, dimming,
+ * clock and each symbol.
+ */
+unsigned int cVFDDriver::FrameBytes() const {
+  unsigned int nColumns = MaxWrite() / SizeYb();
+  if(nColumns < 1)
+    nColumns = 1;
+  unsigned int nWrites = (Width() + nColumns - 1) / nColumns;
+  return (Width() * SizeYb()) + (nWrites * WriteHeader()) + ((Symbols() + 4) * MAX_COMMAND);
+}
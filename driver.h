@@ -0,0 +1,63 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#ifndef __VFD_DRIVER_H___
+#define __VFD_DRIVER_H___
+
+/*
+ * Geometry and command encoding of a column addressed monochrome panel.
+ * RAM of panel is written column by column, each column has SizeYb()
+ * bytes, MSB is the top row. Each Encode... writes a command into buf,
+ * at most MAX_COMMAND bytes, and returns its length, 0 if not supported.
+ */
+class cVFDDriver {
+public:
+  enum { MAX_COMMAND = 16 };
+
+  virtual ~cVFDDriver() {}
+  static cVFDDriver* Create(int nDriver);
+
+  virtual const char* Name() const = 0;
+  /** count of columns */
+  virtual unsigned int Width() const = 0;
+  /** count of rows */
+  virtual unsigned int Height() const = 0;
+  /** bytes of one column */
+  unsigned int SizeYb() const { return (Height() + 7) / 8; }
+
+  /** count of symbols, addressed by bit of cVFD::icons() */
+  virtual unsigned int Symbols() const { return 0; }
+  /** highest dimming level */
+  virtual int DimmMax() const = 0;
+  /** dimming level after reset */
+  virtual int DimmReset() const = 0;
+  /** bytes ahead of data of each RAM write */
+  virtual unsigned int WriteHeader() const = 0;
+  /** most data bytes of one RAM write */
+  virtual unsigned int MaxWrite() const = 0;
+  /** worst case command stream of a frame, whole RAM and all state commands */
+  unsigned int FrameBytes() const;
+
+  /** clear RAM and all symbols, turn clock off, dimming level to DimmReset() */
+  virtual unsigned int EncodeReset(unsigned char* buf) const = 0;
+  virtual unsigned int EncodeDimm(unsigned char* buf, int nLevel) const = 0;
+  virtual unsigned int EncodeSymbol(unsigned char* buf, unsigned int nSymbol, bool bOn) const { return 0; }
+  /** header of a write, nBytes of data follow, which fill RAM from nAddress */
+  virtual unsigned int EncodeWrite(unsigned char* buf, unsigned int nAddress, unsigned int nBytes) const = 0;
+  /** set time of the clock of panel */
+  virtual unsigned int EncodeSetClock(unsigned char* buf, int nHour, int nMinute) const { return 0; }
+  /** show the clock of panel, until RAM is written */
+  virtual unsigned int EncodeShowClock(unsigned char* buf) const { return 0; }
+};
+
+#endif
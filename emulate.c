@@ -0,0 +1,240 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#include <unistd.h>
+#include <vdr/tools.h>
+
+#include "setup.h"
+#include "emulate.h"
+#include "driver.h"
+#include "mdm166a.h"
+
+static inline int fromBCD(unsigned char x) {
+  return ((x >> 4) * 10) + (x & 0x0f);
+}
+
+cVFDTransportEmulate::cVFDTransportEmulate(const cVFDDriver* pDriver, int nLatencyUs, bool bControl)
+: cVFDTransport(pDriver) {
+  bOpen = false;
+  nLatency = nLatencyUs;
+  this->bControl = bControl;
+  bRealtime = true;
+
+  width = pDriver->Width();
+  sizeYb = pDriver->SizeYb();
+  nRamSize = width * sizeYb;
+  nAddressBytes = cVFDDriverMDM166A::AddressBytes(nRamSize);
+  ram = new unsigned char[nRamSize];
+
+  nReports = 0;
+  nBytes = 0;
+  nErrors = 0;
+  Reset();
+}
+
+cVFDTransportEmulate::~cVFDTransportEmulate() {
+  cVFDTransportEmulate::close();
+  delete[] ram;
+}
+
+bool cVFDTransportEmulate::open() {
+  isyslog("targaVFD: using emulated Futaba MDM166A, %ux%u pixel, %d us per report (%s transfer)",
+          width, sizeYb * 8, nLatency * Stages(bControl), bControl ? "control" : "interrupt");
+  Reset();
+  packet->clear();
+  bOpen = true;
+  return true;
+}
+
+void cVFDTransportEmulate::close() {
+  if(bOpen) {
+    dsyslog("targaVFD: emulation done, %lu reports, %lu bytes, %lu errors", nReports, nBytes, nErrors);
+    bOpen = false;
+  }
+}
+
+/**
+ * Reset all configuration data to default and clear
+ */
+void cVFDTransportEmulate::Reset() {
+  decode = eDecodeIdle;
+  nArgs = 0;
+  nArgsNeeded = 0;
+  nPixel = 0;
+
+  memset(ram, 0x00, nRamSize);
+  nAddress = 0;
+  memset(symbols, STATE_OFF, sizeof(symbols));
+  nBrightness = BRIGHT_FULL;
+  nClock = -1;
+  nClockFormat = TIME_24;
+  nClockHour = 0;
+  nClockMinute = 0;
+}
+
+bool cVFDTransportEmulate::Flush() {
+
+  if(packet->empty())
+    return true;
+  if(!isopen()) {
+    packet->clear();
+    return false;
+  }
+
+  for(unsigned int i = 0; i < packet->Reports(); ++i) {
+    const unsigned char* report = packet->Report(i);
+    for(unsigned int n = 1; n <= report[0]; ++n) {
+      Decode(report[n]);
+    }
+    nBytes += report[0];
+    ++nReports;
+    if(bRealtime && nLatency > 0)
+      usleep(nLatency * Stages(bControl));
+  }
+  FrameQueued(packet->Reports());
+  FrameDone(nFrameQueued);
+  packet->clear();
+  return true;
+}
+
+/**
+ * Decode next byte of command stream
+ */
+void cVFDTransportEmulate::Decode(unsigned char c) {
+  switch(decode) {
+    case eDecodeIdle:
+      if(c == CMD_PREFIX)
+        decode = eDecodeCommand;
+      else
+        ++nErrors; // stray data
+      break;
+    case eDecodeCommand:
+      cmd = c;
+      nArgs = 0;
+      switch(cmd) {
+        case CMD_SETCLOCK:
+        case CMD_SETSYMBOL:
+          nArgsNeeded = 2;
+          break;
+        case CMD_SETRAM:
+          nArgsNeeded = nAddressBytes;
+          break;
+        case CMD_SMALLCLOCK:
+        case CMD_BIGCLOCK:
+        case CMD_SETDIMM:
+        case CMD_SETPIXEL:
+          nArgsNeeded = 1;
+          break;
+        case CMD_RESET:
+        case CMD_TEST1:
+        case CMD_TEST2:
+          nArgsNeeded = 0;
+          break;
+        default:
+          ++nErrors; // unknown command
+          decode = eDecodeIdle;
+          return;
+      }
+      decode = eDecodeArgs;
+      if(!nArgsNeeded)
+        Execute();
+      break;
+    case eDecodeArgs:
+      args[nArgs++] = c;
+      if(nArgs == nArgsNeeded)
+        Execute();
+      break;
+    case eDecodePixel:
+      ram[nAddress] = c;
+      nAddress = (nAddress + 1) % nRamSize;
+      if(--nPixel == 0)
+        decode = eDecodeIdle;
+      break;
+  }
+}
+
+/**
+ * Execute a completely received command
+ */
+void cVFDTransportEmulate::Execute() {
+  decode = eDecodeIdle;
+  switch(cmd) {
+    case CMD_SETCLOCK:
+      nClockMinute = fromBCD(args[0]);
+      nClockHour = fromBCD(args[1]);
+      break;
+    case CMD_SMALLCLOCK:
+    case CMD_BIGCLOCK:
+      nClock = cmd;
+      nClockFormat = args[0];
+      break;
+    case CMD_SETSYMBOL:
+      if(args[0] < SYMBOLS && args[1] <= STATE_ONHIGH)
+        symbols[args[0]] = args[1];
+      else
+        ++nErrors;
+      break;
+    case CMD_SETDIMM:
+      if(args[0] <= BRIGHT_FULL)
+        nBrightness = args[0];
+      else
+        ++nErrors;
+      break;
+    case CMD_RESET:
+      Reset();
+      break;
+    case CMD_SETRAM: {
+      unsigned int a = args[0];
+      if(nAddressBytes > 1)
+        a |= args[1] << 8;
+      if(a < nRamSize)
+        nAddress = a;
+      else
+        ++nErrors;
+      break;
+    }
+    case CMD_SETPIXEL:
+      nPixel = args[0];
+      if(nPixel)
+        decode = eDecodePixel;
+      break;
+    case CMD_TEST1:
+    case CMD_TEST2:
+      break;
+  }
+}
+
+/**
+ * Write content of virtual display to syslog
+ */
+void cVFDTransportEmulate::Dump() const {
+  char* line = MALLOC(char, width + 1);
+  if(!line)
+    return;
+  for(unsigned int y = 0; y < sizeYb * 8; ++y) {
+    for(unsigned int x = 0; x < width; ++x) {
+      unsigned char c = ram[(x * sizeYb) + (y / 8)];
+      line[x] = (c & (0x80 >> (y % 8))) ? '#' : '.';
+    }
+    line[width] = '\0';
+    dsyslog("targaVFD: %s", line);
+  }
+  free(line);
+  unsigned int nSymbols = 0;
+  for(unsigned int i = 0; i < SYMBOLS; ++i) {
+    if(symbols[i] != STATE_OFF)
+      nSymbols |= (1 << i);
+  }
+  dsyslog("targaVFD: brightness %d, clock %d (%02d:%02d), symbols 0x%07x", 
+            nBrightness, nClock, nClockHour, nClockMinute, nSymbols);
+}
@@ -0,0 +1,105 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#ifndef __VFD_EMULATE_H___
+#define __VFD_EMULATE_H___
+
+#include "transport.h"
+
+/*
+ * Emulated MDM166A, the command stream is decoded into a 
+ * virtual graphics RAM, symbol state and brightness. 
+ * Needs no hardware, e.g. to measure the render path.
+ * RAM has the geometry of the selected panel.
+ */
+class cVFDTransportEmulate : public cVFDTransport {
+public:
+  static const unsigned int SYMBOLS = 25;
+private:
+  bool bOpen;
+  int nLatency;           ///< modelled duration of a transaction, in microseconds
+  bool bControl;          ///< reports are modelled as control transfers, see Stages()
+  bool bRealtime;         ///< wait the modelled duration, otherwise it's only accounted
+
+  /* decoder, a command may span several reports */
+  enum eDecode { 
+    eDecodeIdle,      ///< wait for CMD_PREFIX
+    eDecodeCommand,   ///< wait for command
+    eDecodeArgs,      ///< collect arguments of command
+    eDecodePixel      ///< data of CMD_SETPIXEL
+  } decode;
+  unsigned char cmd;
+  unsigned char args[3];
+  unsigned int nArgs;
+  unsigned int nArgsNeeded;
+  unsigned int nPixel;
+
+  /* state of virtual device */
+  unsigned int width;
+  unsigned int sizeYb;
+  unsigned int nRamSize;
+  unsigned int nAddressBytes; ///< bytes of address of CMD_SETRAM
+  unsigned char* ram;
+  unsigned int nAddress;
+  unsigned char symbols[SYMBOLS];
+  int nBrightness;
+  int nClock;             ///< -1 none, else CMD_SMALLCLOCK or CMD_BIGCLOCK
+  int nClockFormat;
+  int nClockHour;
+  int nClockMinute;
+
+  /* statistic */
+  unsigned long nReports;
+  unsigned long nBytes;
+  unsigned long nErrors;
+
+  void Reset();
+  void Decode(unsigned char c);
+  void Execute();
+public:
+  cVFDTransportEmulate(const cVFDDriver* pDriver, int nLatencyUs, bool bControl);
+
+  /** 
+   * Transactions of a report: one through the interrupt OUT endpoint, three
+   * (setup, data and status stage) as HID_SET_REPORT control transfer. Each
+   * one is modelled to last the latency.
+   */
+  static unsigned int Stages(bool bControl) { return bControl ? 3 : 1; }
+  virtual ~cVFDTransportEmulate();
+
+  virtual const char* Name() const { return "emulate"; }
+  virtual bool open();
+  virtual void close();
+  virtual bool isopen() const { return bOpen; }
+  virtual bool Flush();
+
+  /** graphics RAM, column by column, as written with CMD_SETPIXEL */
+  const unsigned char* RAM() const { return ram; }
+  unsigned int RAMSize() const { return nRamSize; }
+  /** state of symbol, STATE_OFF, STATE_ON or STATE_ONHIGH */
+  unsigned char Symbol(unsigned int n) const { return n < SYMBOLS ? symbols[n] : 0; }
+  int Brightness() const { return nBrightness; }
+  int Clock() const { return nClock; }
+
+  unsigned long Reports() const { return nReports; }
+  unsigned long Bytes() const { return nBytes; }
+  unsigned long Errors() const { return nErrors; }
+  /** modelled duration of all reports in microseconds, by interrupt or control transfers */
+  unsigned long BusTime(bool bControl) const { return nReports * nLatency * Stages(bControl); }
+  /** wait the modelled duration of each report (default), or only account it, e.g. for a benchmark */
+  void Realtime(bool b) { bRealtime = b; }
+
+  void Dump() const;
+};
+
+#endif
@@ -0,0 +1,43 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#include <vdr/tools.h>
+#include "engine.h"
+
+cVFDEngine* cVFDEngine::Create(unsigned int nWidth, unsigned int nHeight)
+{
+  // targa/MDM166A
+  if (nWidth == 96 && nHeight == 16)
+    return new cVFDEngineFixed<96, 16>();
+  // common graphic panels
+  if (nWidth == 128 && nHeight == 64)
+    return new cVFDEngineFixed<128, 64>();
+  if (nWidth == 256 && nHeight == 64)
+    return new cVFDEngineFixed<256, 64>();
+  dsyslog("targaVFD: no specialized engine for %ux%u", nWidth, nHeight);
+  return new cVFDEngineRuntime(nHeight);
+}
+
+void cVFDEngineRuntime::Diff(const unsigned char* fb, const unsigned char* bs,
+                             unsigned int minX, unsigned int maxX, cVFDPlanner& planner)
+{
+  cVFDKernel<0>::Diff(fb, bs, minX * nSizeYb, maxX * nSizeYb, nSizeYb, planner);
+  nCompared += (maxX - minX) * nSizeYb;
+}
+
+void cVFDEngineRuntime::Copy(const unsigned char* fb, unsigned char* bs,
+                             unsigned int minX, unsigned int maxX)
+{
+  memcpy(bs + (minX * nSizeYb), fb + (minX * nSizeYb), (maxX - minX) * nSizeYb);
+  nCopied += (maxX - minX) * nSizeYb;
+}
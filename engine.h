@@ -0,0 +1,171 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#ifndef __VFD_ENGINE_H___
+#define __VFD_ENGINE_H___
+
+#include <stdint.h>
+#include <string.h>
+#include "planner.h"
+
+/*
+ * Compare and copy columns of canvas and shadow of one display.
+ * Both buffers hold one display, column by column like its RAM.
+ */
+class cVFDEngine {
+protected:
+  unsigned long nCompared;  ///< bytes of canvas compared with shadow
+  unsigned long nCopied;    ///< bytes of canvas taken into shadow
+public:
+  cVFDEngine() : nCompared(0), nCopied(0) {}
+  virtual ~cVFDEngine() {}
+
+  /** engine for the geometry, specialized if known at compile time */
+  static cVFDEngine* Create(unsigned int nWidth, unsigned int nHeight);
+
+  virtual const char* Name() const = 0;
+  /** pass columns within [minX, maxX), which differ, to planner */
+  virtual void Diff(const unsigned char* fb, const unsigned char* bs,
+                    unsigned int minX, unsigned int maxX, cVFDPlanner& planner) = 0;
+  /** take columns [minX, maxX) of canvas into shadow */
+  virtual void Copy(const unsigned char* fb, unsigned char* bs,
+                    unsigned int minX, unsigned int maxX) = 0;
+
+  unsigned long Compared() const { return nCompared; }
+  unsigned long Copied() const { return nCopied; }
+};
+
+/*
+ * Kernels, sizeYb is a template argument or zero for a value given at runtime.
+ * With a constant, strides are folded and the loops over a whole display
+ * have a fixed trip count, which the compiler unrolls. A differing word of
+ * short columns is split by constant shifts, e.g. 96x16 has four columns
+ * per word. Drawing into cVFDBitmap keeps runtime strides, it resolves a
+ * column once per primitive. Both are measured by SVDRP BENCH.
+ */
+template <unsigned int SizeYb>
+struct cVFDKernel {
+  enum { WORD = sizeof(uint64_t) };
+
+  static unsigned int Bytes(unsigned int sizeYb) { return SizeYb ? SizeYb : sizeYb; }
+
+  /** bits of a difference word, which belong to column c of the word, if columns are yb bytes */
+  static uint64_t ColumnBits(uint64_t d, unsigned int c, unsigned int yb) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    c = (WORD / yb) - 1 - c;
+#endif
+    return yb == WORD ? d : (d >> (c * yb * 8)) & ((((uint64_t) 1) << (yb * 8)) - 1);
+  }
+
+  /*
+   * Changed columns are collected into runs, so the planner
+   * is called once per run instead of once per column.
+   */
+  struct Runs {
+    cVFDPlanner& planner;
+    unsigned int minX;
+    unsigned int maxX;
+    Runs(cVFDPlanner& p) : planner(p), minX(0), maxX(0) {}
+    ~Runs() { if (maxX > minX) planner.Dirty(minX, maxX); }
+    void Dirty(unsigned int x) {
+      if (x < maxX)
+        return;
+      if (x > maxX) {
+        if (maxX > minX)
+          planner.Dirty(minX, maxX);
+        minX = x;
+      }
+      maxX = x + 1;
+    }
+  };
+
+  static void Diff(const unsigned char* fb, const unsigned char* bs,
+                   unsigned int i, unsigned int n, unsigned int sizeYb, cVFDPlanner& planner) {
+    const unsigned int yb = Bytes(sizeYb);
+    // i starts at a column, so a word holds either a part of one column or whole columns
+    const bool bWordColumns = (yb % WORD) == 0;
+    const bool bColumnsInWord = (WORD % yb) == 0;
+    Runs runs(planner);
+    for (; i + WORD <= n; i += WORD) {
+      uint64_t a, b;
+      memcpy(&a, fb + i, sizeof(a));
+      memcpy(&b, bs + i, sizeof(b));
+      if (a == b)
+        continue;
+      if (bWordColumns) {
+        runs.Dirty(i / yb);
+      } else if (bColumnsInWord) {
+        // e.g. four columns of 96x16, constant shifts with a fixed geometry
+        const uint64_t d = a ^ b;
+        const unsigned int x = i / yb;
+        for (unsigned int c = 0; c < WORD / yb; ++c)
+          if (ColumnBits(d, c, yb))
+            runs.Dirty(x + c);
+      } else {
+        for (unsigned int j = i; j < i + WORD; ++j)
+          if (fb[j] != bs[j])
+            runs.Dirty(j / yb);
+      }
+    }
+    for (; i < n; ++i)
+      if (fb[i] != bs[i])
+        runs.Dirty(i / yb);
+  }
+};
+
+/*
+ * Engine of a display with geometry known at compile time.
+ */
+template <unsigned int Width, unsigned int Height>
+class cVFDEngineFixed : public cVFDEngine {
+public:
+  enum { SizeYb = (Height + 7) / 8, Bytes = Width * SizeYb };
+
+  virtual const char* Name() const { return "fixed"; }
+  virtual void Diff(const unsigned char* fb, const unsigned char* bs,
+                    unsigned int minX, unsigned int maxX, cVFDPlanner& planner) {
+    if (minX == 0 && maxX == Width) {
+      // whole display, constant bounds
+      cVFDKernel<SizeYb>::Diff(fb, bs, 0, Bytes, SizeYb, planner);
+      nCompared += Bytes;
+      return;
+    }
+    cVFDKernel<SizeYb>::Diff(fb, bs, minX * SizeYb, maxX * SizeYb, SizeYb, planner);
+    nCompared += (maxX - minX) * SizeYb;
+  }
+  virtual void Copy(const unsigned char* fb, unsigned char* bs,
+                    unsigned int minX, unsigned int maxX) {
+    if (minX == 0 && maxX == Width)
+      memcpy(bs, fb, Bytes);
+    else
+      memcpy(bs + (minX * SizeYb), fb + (minX * SizeYb), (maxX - minX) * SizeYb);
+    nCopied += (maxX - minX) * SizeYb;
+  }
+};
+
+/*
+ * Engine of a display with any geometry.
+ */
+class cVFDEngineRuntime : public cVFDEngine {
+  unsigned int nSizeYb;
+public:
+  cVFDEngineRuntime(unsigned int nHeight) : nSizeYb((nHeight + 7) / 8) {}
+
+  virtual const char* Name() const { return "runtime"; }
+  virtual void Diff(const unsigned char* fb, const unsigned char* bs,
+                    unsigned int minX, unsigned int maxX, cVFDPlanner& planner);
+  virtual void Copy(const unsigned char* fb, unsigned char* bs,
+                    unsigned int minX, unsigned int maxX);
+};
+
+#endif
@@ -12,61 +12,134 @@
  *
  */
 
+#include <stdlib.h>
+#include <sys/stat.h>
 #include <vdr/tools.h>
 #include "ffont.h"
 
 // --- cVFDFont ---------------------------------------------------------
 
-#define KERNING_UNKNOWN  (-10000)
-
-cVFDGlyph::cVFDGlyph(uint CharCode, FT_GlyphSlotRec_ *GlyphData)
+cVFDGlyph::cVFDGlyph(uint CharCode, FT_GlyphSlotRec_ *GlyphData, cVFDArena &Arena)
 {
   charCode = CharCode;
+  arena = &Arena;
+  hashNext = NULL;
+  flags = 0;
   advanceX = GlyphData->advance.x >> 6;
   advanceY = GlyphData->advance.y >> 6;
   left = GlyphData->bitmap_left;
   top = GlyphData->bitmap_top;
   width = GlyphData->bitmap.width;
   rows = GlyphData->bitmap.rows;
-  pitch = GlyphData->bitmap.pitch;
-  bitmap = MALLOC(uchar, rows * pitch);
-  memcpy(bitmap, GlyphData->bitmap.buffer, rows * pitch);
+  // turn rows of FreeType into columns, so a glyph is drawn byte by byte
+  const int bytesPerColumn = (rows + 7) / 8;
+  const int pitch = abs(GlyphData->bitmap.pitch);
+  const bool mono = GlyphData->bitmap.pixel_mode == FT_PIXEL_MODE_MONO;
+  bitmap = NULL;
+  if (width > 0 && bytesPerColumn > 0) {
+     bitmap = arena->Alloc(width * bytesPerColumn);
+     if (!bitmap)
+        width = rows = 0;
+     else
+        memset(bitmap, 0x00, width * bytesPerColumn);
+     for (int row = 0; row < rows; row++) {
+         const uchar *src = GlyphData->bitmap.buffer + (row * pitch);
+         for (int col = 0; col < width; col++) {
+             if (mono ? (src[col / 8] & (0x80 >> (col % 8))) : (src[col] & 0x80))
+                bitmap[(col * bytesPerColumn) + (row / 8)] |= 0x80 >> (row % 8);
+             }
+         }
+     }
 }
 
-cVFDGlyph::~cVFDGlyph()
+/**
+ * Copy of a glyph, stored for another character, e.g. the
+ * indicator of a missing character.
+ */
+cVFDGlyph::cVFDGlyph(uint CharCode, const cVFDGlyph &Glyph)
 {
-  free(bitmap);
+  charCode = CharCode;
+  arena = Glyph.arena;
+  hashNext = NULL;
+  flags = Glyph.flags;
+  advanceX = Glyph.advanceX;
+  advanceY = Glyph.advanceY;
+  left = Glyph.left;
+  top = Glyph.top;
+  width = Glyph.width;
+  rows = Glyph.rows;
+  bitmap = NULL;
+  if (Glyph.bitmap) {
+     bitmap = arena->Alloc(Bytes());
+     if (!bitmap)
+        width = rows = 0;
+     else
+        memcpy(bitmap, Glyph.bitmap, Bytes());
+     }
 }
 
-int cVFDGlyph::GecVFDKerningCache(uint PrevSym) const
+/**
+ * Glyph of a previous run, taken from cache file.
+ */
+cVFDGlyph::cVFDGlyph(const cVFDGlyphFile::tGlyph &Glyph, const uchar *Bitmap, cVFDArena &Arena)
 {
-  for (int i = kerningCache.Size(); --i > 0; ) {
-      if (kerningCache[i].prevSym == PrevSym)
-         return kerningCache[i].kerning;
-      }
-  return KERNING_UNKNOWN;
+  charCode = Glyph.charCode;
+  arena = &Arena;
+  hashNext = NULL;
+  flags = Glyph.flags;
+  advanceX = Glyph.advanceX;
+  advanceY = Glyph.advanceY;
+  left = Glyph.left;
+  top = Glyph.top;
+  width = Glyph.width;
+  rows = Glyph.rows;
+  bitmap = NULL;
+  if (Bytes()) {
+     bitmap = arena->Alloc(Bytes());
+     if (!bitmap)
+        width = rows = 0;
+     else
+        memcpy(bitmap, Bitmap, Bytes());
+     }
 }
 
-void cVFDGlyph::SecVFDKerningCache(uint PrevSym, int Kerning)
+cVFDGlyph::~cVFDGlyph()
 {
-  kerningCache.Append(cVFDKerning(PrevSym, Kerning));
+  arena->Free(bitmap, Bytes());
 }
 
 
 
-cVFDFont::cVFDFont(const char *Name, int CharHeight, int CharWidth)
+cVFDFont::cVFDFont(const char *Name, int CharHeight, int CharWidth, const char *CacheDir)
 {
   height = 0;
   bottom = 0;
   width = CharWidth;
+  hasKerning = false;
+  nKerningBuilt = 0;
+  memset(&cacheStat, 0, sizeof(cacheStat));
+  nCacheLimit = 0;
+  nResident = 0;
+  cacheDirty = false;
+  fallbackKey = "";
+  nFallback = 0;
+  nMissing = 0;
+  charHeight = CharHeight;
+  charWidth = CharWidth;
+  memset(glyphDirect, 0, sizeof(glyphDirect));
+  memset(glyphHash, 0, sizeof(glyphHash));
   int error = FT_Init_FreeType(&library);
   if (!error) {
      error = FT_New_Face(library, Name, 0, &face);
      if (!error) {
+        if (CacheDir && *CacheDir)
+           MapCache(Name, CacheDir);
         if (face->num_fixed_sizes && face->available_sizes) { // fixed font
            // TODO what exactly does all this mean?
            height = face->available_sizes->height;
-           for (uint sym ='A'; sym < 'z'; sym++) { // search for descender for fixed font FIXME
+           if (glyphFile.Mapped())
+              bottom = glyphFile.Bottom(); // searched by a previous run
+           for (uint sym ='A'; sym < 'z' && !glyphFile.Mapped(); sym++) { // search for descender for fixed font FIXME
                FT_UInt glyph_index = FT_Get_Char_Index(face, sym);
                error = FT_Load_Glyph(face, glyph_index, FT_LOAD_DEFAULT);
                if (!error) {
@@ -95,6 +168,10 @@ cVFDFont::cVFDFont(const char *Name, int CharHeight, int CharWidth)
            else
               esyslog("targaVFD: FreeType: error %d during FT_Set_Char_Size (font = %s)\n", error, Name);
            }
+        if (glyphFile.Mapped())
+           LoadKerning();
+        else
+           BuildKerning();
         }
      else
         esyslog("targaVFD: FreeType: load error %d (font = %s)", error, Name);
@@ -105,68 +182,373 @@ cVFDFont::cVFDFont(const char *Name, int CharHeight, int CharWidth)
 
 cVFDFont::~cVFDFont()
 {
+  SaveCache();
+  glyphCacheMonochrome.Clear(); // bitmaps are returned to arena
+  for (int i = 0; i < nFallback; i++)
+      FT_Done_Face(fallback[i]);
   FT_Done_Face(face);
   FT_Done_FreeType(library);
 }
 
+/**
+ * Add a face, which is asked for characters missing in the font.
+ * Faces are asked in order of addition.
+ */
+bool cVFDFont::AddFallback(const char *Name)
+{
+  if (!height || nFallback >= MAX_FALLBACK)
+     return false;
+  FT_Face f;
+  int error = FT_New_Face(library, Name, 0, &f);
+  if (error) {
+     esyslog("targaVFD: FreeType: load error %d (fallback font = %s)", error, Name);
+     return false;
+     }
+  if (!(f->num_fixed_sizes && f->available_sizes)) {
+     error = FT_Set_Char_Size(f, charWidth << 6, charHeight << 6, charWidth > 8 ? 64 : 80, 72);
+     if (error) {
+        esyslog("targaVFD: FreeType: error %d during FT_Set_Char_Size (fallback font = %s)", error, Name);
+        FT_Done_Face(f);
+        return false;
+        }
+     }
+  fallback[nFallback++] = f;
+  fallbackKey = cString::sprintf("%s%s%s", *fallbackKey, nFallback > 1 ? "," : "", Name);
+  dsyslog("targaVFD: FreeType: fallback font %s", Name);
+  return true;
+}
+
+/**
+ * Build table of all Latin-1 pairs, which have a kerning.
+ * Skipped, if the font has no kerning at all.
+ */
+void cVFDFont::BuildKerning()
+{
+  kerningTable.clear();
+  hasKerning = FT_HAS_KERNING(face);
+  if (!hasKerning)
+     return;
+
+  FT_UInt index[KERNING_LAST + 1];
+  for (uint sym = KERNING_FIRST; sym <= KERNING_LAST; sym++)
+      index[sym] = FT_Get_Char_Index(face, sym);
+  for (uint prev = KERNING_FIRST; prev <= KERNING_LAST; prev++) {
+      if (!index[prev])
+         continue;
+      for (uint sym = KERNING_FIRST; sym <= KERNING_LAST; sym++) {
+          FT_Vector delta;
+          if (!index[sym] || FT_Get_Kerning(face, index[prev], index[sym], FT_KERNING_DEFAULT, &delta))
+             continue;
+          if (delta.x / 64)
+             kerningTable.Insert(prev, sym, delta.x / 64);
+          }
+      }
+  nKerningBuilt = kerningTable.Count();
+  dsyslog("targaVFD: FreeType: %u kerning pairs", nKerningBuilt);
+}
+
 int cVFDFont::Kerning(cVFDGlyph *Glyph, uint PrevSym) const
 {
   int kerning = 0;
-  if (Glyph && PrevSym) {
-     kerning = Glyph->GecVFDKerningCache(PrevSym);
-     if (kerning == KERNING_UNKNOWN) {
-        FT_Vector delta;
-        FT_UInt glyph_index = FT_Get_Char_Index(face, Glyph->CharCode());
-        FT_UInt glyph_index_prev = FT_Get_Char_Index(face, PrevSym);
-        FT_Get_Kerning(face, glyph_index_prev, glyph_index, FT_KERNING_DEFAULT, &delta);
+  if (hasKerning && Glyph && PrevSym) {
+     uint sym = Glyph->CharCode();
+     if (kerningTable.Lookup(PrevSym, sym, kerning))
+        return kerning;
+     if (KerningBuilt(PrevSym) && KerningBuilt(sym))
+        return 0; // not in table, no kerning
+     FT_Vector delta;
+     FT_UInt glyph_index = FT_Get_Char_Index(face, sym);
+     FT_UInt glyph_index_prev = FT_Get_Char_Index(face, PrevSym);
+     if (!FT_Get_Kerning(face, glyph_index_prev, glyph_index, FT_KERNING_DEFAULT, &delta))
         kerning = delta.x / 64;
-        Glyph->SecVFDKerningCache(PrevSym, kerning);
-        }
+     if (kerningTable.Count() < nKerningBuilt + KERNING_DEMAND)
+        kerningTable.Insert(PrevSym, sym, kerning);
      }
   return kerning;
 }
 
-cVFDGlyph* cVFDFont::Glyph(uint CharCode) const
+cVFDGlyph* cVFDFont::Lookup(uint CharCode) const
 {
-  // Non-breaking space:
-  if (CharCode == 0xA0)
-     CharCode = 0x20;
-
-  // Lookup in cache:
-  cList<cVFDGlyph> *glyphCache = &glyphCacheMonochrome;
-  for (cVFDGlyph *g = glyphCache->First(); g; g = glyphCache->Next(g)) {
+  if (CharCode < GLYPH_DIRECT)
+     return glyphDirect[CharCode];
+  for (cVFDGlyph *g = glyphHash[CharCode % GLYPH_HASH]; g; g = g->hashNext) {
       if (g->CharCode() == CharCode)
          return g;
       }
+  return NULL;
+}
 
-  FT_UInt glyph_index = FT_Get_Char_Index(face, CharCode);
+/**
+ * Lookup in cache, a found glyph becomes the most recently used.
+ */
+cVFDGlyph* cVFDFont::Cached(uint CharCode) const
+{
+  cVFDGlyph *g = Lookup(CharCode);
+  if (g) {
+     cacheStat.nHits++;
+     if (g != glyphCacheMonochrome.First()) {
+        glyphCacheMonochrome.Del(g, false);
+        glyphCacheMonochrome.Ins(g);
+        }
+     }
+  return g;
+}
+
+void cVFDFont::AddGlyph(cVFDGlyph *Glyph) const
+{
+  glyphCacheMonochrome.Ins(Glyph);
+  uint CharCode = Glyph->CharCode();
+  if (CharCode < GLYPH_DIRECT)
+     glyphDirect[CharCode] = Glyph;
+  else {
+     Glyph->hashNext = glyphHash[CharCode % GLYPH_HASH];
+     glyphHash[CharCode % GLYPH_HASH] = Glyph;
+     }
+  nResident += Glyph->Resident();
+  Evict();
+}
 
+/**
+ * Drop least recently used glyphs, until the memory of arena fits
+ * into limit. The most recently used glyph is kept in any case.
+ */
+void cVFDFont::Evict(void) const
+{
+  while (nCacheLimit && Footprint() > nCacheLimit && glyphCacheMonochrome.Count() > 1) {
+        cVFDGlyph *g = glyphCacheMonochrome.Last();
+        uint CharCode = g->CharCode();
+        if (CharCode < GLYPH_DIRECT)
+           glyphDirect[CharCode] = NULL;
+        else {
+           cVFDGlyph **p = &glyphHash[CharCode % GLYPH_HASH];
+           while (*p != g)
+                 p = &(*p)->hashNext;
+           *p = g->hashNext;
+           }
+        nResident -= g->Resident();
+        cacheStat.nEvictions++;
+        glyphCacheMonochrome.Del(g);
+        }
+}
+
+void cVFDFont::SetCacheLimit(unsigned long nBytes)
+{
+  nCacheLimit = nBytes;
+  Evict();
+}
+
+void cVFDFont::CacheStatistic(cVFDGlyphCacheStat &s) const
+{
+  s = cacheStat;
+  s.nGlyphs = glyphCacheMonochrome.Count();
+  s.nResident = nResident;
+  s.nReserved = Footprint();
+  s.nKerning = kerningTable.Bytes();
+  s.nLimit = nCacheLimit;
+}
+
+/**
+ * Render a glyph of a face and add it to the cache.
+ */
+cVFDGlyph* cVFDFont::Render(FT_Face Face, FT_UInt GlyphIndex, uint CharCode) const
+{
   // Load glyph image into the slot (erase previous one):
-  int error = FT_Load_Glyph(face, glyph_index, FT_LOAD_DEFAULT);
+  int error = FT_Load_Glyph(Face, GlyphIndex, FT_LOAD_DEFAULT);
   if (error)
      esyslog("targaVFD: FreeType: error during FT_Load_Glyph");
   else {
 #if ((FREETYPE_MAJOR == 2 && FREETYPE_MINOR == 1 && FREETYPE_PATCH >= 7) \
   || (FREETYPE_MAJOR == 2 && FREETYPE_MINOR == 2 && FREETYPE_PATCH <= 1))
      if (CharCode == 32) // workaround for libfreetype bug
-        error = FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL);
+        error = FT_Render_Glyph(Face->glyph, FT_RENDER_MODE_NORMAL);
      else
 #endif
-     error = FT_Render_Glyph(face->glyph, FT_RENDER_MODE_MONO);
+     error = FT_Render_Glyph(Face->glyph, FT_RENDER_MODE_MONO);
      if (error)
-        esyslog("targaVFD: FreeType: error during FT_Render_Glyph %d, %d\n", CharCode, glyph_index);
+        esyslog("targaVFD: FreeType: error during FT_Render_Glyph %d, %d\n", CharCode, GlyphIndex);
      else { //new bitmap
-        cVFDGlyph *Glyph = new cVFDGlyph(CharCode, face->glyph);
-        glyphCache->Add(Glyph);
+        cVFDGlyph *Glyph = new cVFDGlyph(CharCode, Face->glyph, arena);
+        AddGlyph(Glyph);
         return Glyph;
         }
      }
+  return NULL;
+}
+
+cVFDGlyph* cVFDFont::Glyph(uint CharCode) const
+{
+  // Non-breaking space:
+  if (CharCode == 0xA0)
+     CharCode = 0x20;
+
+  // Lookup in cache, missing characters are cached as indicator:
+  cVFDGlyph *g = Cached(CharCode);
+  if (g)
+     return g;
+
+  // rendered by a previous run
+  g = Mapped(CharCode);
+  if (g)
+     return g;
+
+  cacheStat.nMisses++;
+  cacheDirty = true;
+
+  // font, then the fallback fonts
+  FT_UInt glyph_index = FT_Get_Char_Index(face, CharCode);
+  if (glyph_index)
+     g = Render(face, glyph_index, CharCode);
+  for (int i = 0; !g && i < nFallback; i++) {
+      glyph_index = FT_Get_Char_Index(fallback[i], CharCode);
+      if (glyph_index && (g = Render(fallback[i], glyph_index, CharCode)) != NULL)
+         g->flags = cVFDGlyphFile::eFlagFallback;
+      }
+  if (g)
+     return g;
+
 #define UNKNOWN_GLYPH_INDICATOR '?'
-  if (CharCode != UNKNOWN_GLYPH_INDICATOR)
-     return Glyph(UNKNOWN_GLYPH_INDICATOR);
+  if (CharCode != UNKNOWN_GLYPH_INDICATOR) {
+     cVFDGlyph *u = Glyph(UNKNOWN_GLYPH_INDICATOR);
+     if (u) {
+        // remember the miss, FreeType isn't asked again
+        g = new cVFDGlyph(CharCode, *u);
+        g->flags = cVFDGlyphFile::eFlagMissing;
+        AddGlyph(g);
+        if (++nMissing <= 10)
+           dsyslog("targaVFD: FreeType: no glyph for character 0x%04x", CharCode);
+        }
+     return g;
+     }
   return NULL;
 }
 
+/**
+ * Map cache file of font, it's named by a hash of the key.
+ */
+void cVFDFont::MapCache(const char *Name, const char *CacheDir)
+{
+  struct stat st;
+  if (stat(Name, &st))
+     return;
+  cacheKey = cString::sprintf("%s:%ld:%lld:%d:%d", Name, (long) st.st_mtime,
+                              (long long) st.st_size, charHeight, charWidth);
+  uint32_t hash = 2166136261u; // FNV-1a
+  for (const char *p = cacheKey; *p; p++)
+      hash = (hash ^ (uchar) *p) * 16777619u;
+  cacheFile = cString::sprintf("%s/%08x.glyphs", CacheDir, hash);
+  if (glyphFile.Map(cacheFile, cacheKey))
+     dsyslog("targaVFD: FreeType: %u glyphs mapped from %s", glyphFile.Glyphs(), *cacheFile);
+  else
+     cacheDirty = true;
+}
+
+/**
+ * Kerning pairs of a previous run, instead of BuildKerning().
+ */
+void cVFDFont::LoadKerning()
+{
+  kerningTable.clear();
+  hasKerning = glyphFile.Kerning();
+  for (unsigned int i = 0; i < glyphFile.Pairs(); i++) {
+      const cVFDGlyphFile::tPair &p = glyphFile.Pair(i);
+      kerningTable.Insert(p.prevSym, p.sym, p.kerning);
+      }
+  nKerningBuilt = kerningTable.Count();
+}
+
+/**
+ * Glyph of cache file, added to cache. Glyphs of fallback fonts
+ * are only taken, if the same fallback fonts are used.
+ */
+cVFDGlyph* cVFDFont::Mapped(uint CharCode) const
+{
+  const cVFDGlyphFile::tGlyph *m = glyphFile.Find(CharCode);
+  if (!m)
+     return NULL;
+  if ((m->flags & (cVFDGlyphFile::eFlagFallback | cVFDGlyphFile::eFlagMissing))
+      && strcmp(fallbackKey, glyphFile.FallbackKey()))
+     return NULL;
+  cVFDGlyph *g = new cVFDGlyph(*m, glyphFile.Bitmap(*m), arena);
+  cacheStat.nMapped++;
+  AddGlyph(g);
+  return g;
+}
+
+static int CompareGlyph(const void *a, const void *b)
+{
+  uint x = ((const cVFDGlyphFile::tGlyph *) a)->charCode;
+  uint y = ((const cVFDGlyphFile::tGlyph *) b)->charCode;
+  return x < y ? -1 : x > y ? 1 : 0;
+}
+
+/**
+ * Write cached glyphs and still valid glyphs of cache file,
+ * if glyphs were rendered.
+ */
+void cVFDFont::SaveCache() const
+{
+  if (!cacheDirty || isempty(cacheFile) || !height)
+     return;
+  unsigned int nMax = glyphCacheMonochrome.Count() + (glyphFile.Mapped() ? glyphFile.Glyphs() : 0);
+  unsigned int nBytes = 0;
+  for (cVFDGlyph *g = glyphCacheMonochrome.First(); g; g = glyphCacheMonochrome.Next(g))
+      nBytes += g->Bytes();
+  for (unsigned int i = 0; glyphFile.Mapped() && i < glyphFile.Glyphs(); i++)
+      nBytes += glyphFile.Glyph(i).width * ((glyphFile.Glyph(i).rows + 7) / 8);
+  cVFDGlyphFile::tGlyph *glyphs = MALLOC(cVFDGlyphFile::tGlyph, nMax ? nMax : 1);
+  uchar *bitmaps = MALLOC(uchar, nBytes ? nBytes : 1);
+  cVFDGlyphFile::tPair *pairs = MALLOC(cVFDGlyphFile::tPair, kerningTable.Count() ? kerningTable.Count() : 1);
+  if (glyphs && bitmaps && pairs) {
+     unsigned int n = 0;
+     unsigned int offset = 0;
+     for (cVFDGlyph *g = glyphCacheMonochrome.First(); g; g = glyphCacheMonochrome.Next(g)) {
+         cVFDGlyphFile::tGlyph &e = glyphs[n++];
+         e.charCode = g->CharCode();
+         e.advanceX = g->AdvanceX();
+         e.advanceY = g->AdvanceY();
+         e.left = g->Left();
+         e.top = g->Top();
+         e.width = g->Width();
+         e.rows = g->Rows();
+         e.flags = g->flags;
+         e.offset = offset;
+         if (g->Bytes())
+            memcpy(bitmaps + offset, g->Bitmap(), g->Bytes());
+         offset += g->Bytes();
+         }
+     // glyphs of a previous run, which were evicted or not used by this run
+     for (unsigned int i = 0; glyphFile.Mapped() && i < glyphFile.Glyphs(); i++) {
+         const cVFDGlyphFile::tGlyph &m = glyphFile.Glyph(i);
+         if (Lookup(m.charCode)
+             || ((m.flags & (cVFDGlyphFile::eFlagFallback | cVFDGlyphFile::eFlagMissing))
+                 && strcmp(fallbackKey, glyphFile.FallbackKey())))
+            continue;
+         const unsigned int nGlyphBytes = m.width * ((m.rows + 7) / 8);
+         glyphs[n] = m;
+         glyphs[n++].offset = offset;
+         memcpy(bitmaps + offset, glyphFile.Bitmap(m), nGlyphBytes);
+         offset += nGlyphBytes;
+         }
+     qsort(glyphs, n, sizeof(cVFDGlyphFile::tGlyph), CompareGlyph);
+     unsigned int nPairs = 0;
+     for (unsigned int i = 0; i < kerningTable.Slots(); i++) {
+         uint prevSym, sym;
+         int kerning;
+         if (kerningTable.Slot(i, prevSym, sym, kerning)) {
+            pairs[nPairs].prevSym = prevSym;
+            pairs[nPairs].sym = sym;
+            pairs[nPairs++].kerning = kerning;
+            }
+         }
+     if (cVFDGlyphFile::Write(cacheFile, cacheKey, fallbackKey, height, bottom, hasKerning,
+                              pairs, nPairs, glyphs, n, bitmaps, offset))
+        dsyslog("targaVFD: FreeType: %u glyphs written to %s", n, *cacheFile);
+     }
+  free(glyphs);
+  free(bitmaps);
+  free(pairs);
+}
+
 int cVFDFont::Width(uint c) const
 {
   cVFDGlyph *g = Glyph(c);
@@ -204,23 +586,16 @@ int cVFDFont::DrawText(cVFDBitmap *Bitmap, int x, int y, const char *s, int Widt
               continue;
            int kerning = Kerning(g, prevSym);
            prevSym = sym;
-           uchar *buffer = g->Bitmap();
            int symWidth = g->Width();
            if (Width && x + symWidth + g->Left() + kerning - 1 > Width)
               return x; // we don't draw partial characters
-           if (x + symWidth + g->Left() + kerning > 0) {
-              for (int row = 0; row < g->Rows(); row++) {
-                  for (int pitch = 0; pitch < g->Pitch(); pitch++) {
-                      uchar bt = *(buffer + (row * g->Pitch() + pitch));
-                      for (int col = 0; col < 8 && col + pitch * 8 <= symWidth; col++) {
-                         if (bt & 0x80)
-                            Bitmap->SetPixel(x + col + pitch * 8 + g->Left() + kerning,
-                                             y + row + (height - Bottom() - g->Top()));
-                         bt <<= 1;
-                         }
-                      }
-                  }
-              }
+           // whole glyphs outside of clip are skipped
+           const cVFDClip& clip = Bitmap->Clip();
+           const int gx = x + g->Left() + kerning;
+           if (gx + symWidth > clip.x1 && gx <= clip.x2)
+              Bitmap->Blit(gx,
+                           y + (height - Bottom() - g->Top()),
+                           g->Bitmap(), symWidth, g->Rows());
            x += g->AdvanceX() + kerning;
            if (x > Bitmap->Width() - 1)
               return x - (g->AdvanceX() + kerning);
@@ -21,28 +21,33 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include "bitmap.h"
-
-struct cVFDKerning {
-  uint prevSym;
-  int kerning;
-  cVFDKerning(uint PrevSym, int Kerning = 0) { prevSym = PrevSym; kerning = Kerning; }
-  };
+#include "kerning.h"
+#include "arena.h"
+#include "glyphfile.h"
 
 class cVFDGlyph : public cListObject {
 private:
   uint charCode;
-  uchar *bitmap;
+  uchar *bitmap;   ///< column by column, like framebuffer : x * ((rows + 7) / 8) + y / 8
   int advanceX;
   int advanceY;
   int left;  ///< The bitmap's left bearing expressed in integer pixels.
   int top;   ///< The bitmap's top bearing expressed in integer pixels.
   int width; ///< The number of pixels per bitmap row.
   int rows;  ///< The number of bitmap rows.
-  int pitch; ///< The pitch's absolute value is the number of bytes taken by one bitmap row, including padding.
-  cVector<cVFDKerning> kerningCache;
+  cVFDArena *arena; ///< store of bitmap
 public:
-  cVFDGlyph(uint CharCode, FT_GlyphSlotRec_ *GlyphData);
+  cVFDGlyph *hashNext;  ///< next glyph in same bucket of cVFDFont
+  uint flags;           ///< origin of glyph, see cVFDGlyphFile::eFlags
+
+  cVFDGlyph(uint CharCode, FT_GlyphSlotRec_ *GlyphData, cVFDArena &Arena);
+  cVFDGlyph(uint CharCode, const cVFDGlyph &Glyph);
+  cVFDGlyph(const cVFDGlyphFile::tGlyph &Glyph, const uchar *Bitmap, cVFDArena &Arena);
   virtual ~cVFDGlyph();
+  /** bytes of bitmap */
+  unsigned int Bytes(void) const { return width * ((rows + 7) / 8); }
+  /** bytes, which glyph occupies in cache */
+  unsigned int Resident(void) const { return sizeof(cVFDGlyph) + cVFDArena::Size(Bytes()); }
   uint CharCode(void) const { return charCode; }
   uchar *Bitmap(void) const { return bitmap; }
   int AdvanceX(void) const { return advanceX; }
@@ -51,12 +56,24 @@ public:
   int Top(void) const { return top; }
   int Width(void) const { return width; }
   int Rows(void) const { return rows; }
-  int Pitch(void) const { return pitch; }
-  int GecVFDKerningCache(uint PrevSym) const;
-  void SecVFDKerningCache(uint PrevSym, int Kerning);
   };
 
 
+/*
+ * Counters of glyph cache
+ */
+struct cVFDGlyphCacheStat {
+  unsigned long nHits;
+  unsigned long nMisses;     ///< rendered glyphs and missing characters
+  unsigned long nMapped;     ///< glyphs taken from cache file
+  unsigned long nEvictions;
+  unsigned int  nGlyphs;
+  unsigned long nResident;   ///< bytes of cached glyphs
+  unsigned long nReserved;   ///< bytes of arena and glyphs, the limit applies to them
+  unsigned long nKerning;    ///< bytes of kerning table
+  unsigned long nLimit;      ///< cap of resident bytes, 0 if unlimited
+};
+
 class cVFDFont : public cFont {
 private:
   int height;
@@ -64,7 +81,48 @@ private:
   int width;
   FT_Library library; ///< Handle to library
   FT_Face face; ///< Handle to face object
+  /* faces, which are asked for characters missing in face */
+  enum { MAX_FALLBACK = 4 };
+  FT_Face fallback[MAX_FALLBACK];
+  int nFallback;
+  int charHeight;
+  int charWidth;
+  mutable unsigned int nMissing;  ///< characters, which no face has
+  cVFDGlyph* Render(FT_Face Face, FT_UInt GlyphIndex, uint CharCode) const;
+  /* kerning of all Latin-1 pairs, built at load, other pairs on demand */
+  enum { KERNING_FIRST = 0x20, KERNING_LAST = 0xFF };
+  bool hasKerning;
+  mutable cVFDKerningTable kerningTable;
+  enum { KERNING_DEMAND = 4096 };  ///< pairs above Latin-1, which are stored
+  unsigned int nKerningBuilt;
+  void BuildKerning();
+  static bool KerningBuilt(uint Sym) { return Sym >= KERNING_FIRST && Sym <= KERNING_LAST; }
+  /* glyphs, most recently used first, bitmaps stored by arena */
+  mutable cVFDArena arena;
   mutable cList<cVFDGlyph> glyphCacheMonochrome;
+  mutable cVFDGlyphCacheStat cacheStat;
+  unsigned long nCacheLimit;
+  mutable unsigned long nResident;
+  /* glyphs of previous runs, mapped from cache file */
+  cVFDGlyphFile glyphFile;
+  cString cacheFile;
+  cString cacheKey;
+  cString fallbackKey;       ///< fallback fonts, which resolved missing characters
+  mutable bool cacheDirty;   ///< glyphs were rendered, which aren't in file
+  void MapCache(const char *Name, const char *CacheDir);
+  void LoadKerning();
+  cVFDGlyph* Mapped(uint CharCode) const;
+  void SaveCache() const;
+  /* index of cache, direct for Latin-1, hashed for all other */
+  enum { GLYPH_DIRECT = 256, GLYPH_HASH = 64 };
+  mutable cVFDGlyph *glyphDirect[GLYPH_DIRECT];
+  mutable cVFDGlyph *glyphHash[GLYPH_HASH];
+  cVFDGlyph* Lookup(uint CharCode) const;
+  cVFDGlyph* Cached(uint CharCode) const;
+  void AddGlyph(cVFDGlyph *Glyph) const;
+  void Evict(void) const;
+  /** memory of cache, which is capped by limit */
+  unsigned long Footprint(void) const { return arena.Reserved() + glyphCacheMonochrome.Count() * sizeof(cVFDGlyph); }
   int Bottom(void) const { return bottom; }
   int Kerning(cVFDGlyph *Glyph, uint PrevSym) const;
   cVFDGlyph* Glyph(uint CharCode) const;
@@ -73,8 +131,13 @@ private:
   virtual void DrawText(cPixmap*, int, int, const char*, tColor, tColor, int) const {};
 #endif
 public:
-  cVFDFont(const char *Name, int CharHeight, int CharWidth = 0);
+  cVFDFont(const char *Name, int CharHeight, int CharWidth = 0, const char *CacheDir = NULL);
   virtual ~cVFDFont();
+  /** add a face, which is asked for characters missing in font */
+  bool AddFallback(const char *Name);
+  /** cap resident bytes of glyph cache, least recently used glyphs are dropped, 0 for unlimited */
+  void SetCacheLimit(unsigned long nBytes);
+  void CacheStatistic(cVFDGlyphCacheStat &s) const;
   virtual int Width(void) const { return width; }
   virtual int Width(uint c) const;
   virtual int Width(const char *s) const;
@@ -0,0 +1,175 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <vdr/tools.h>
+
+#include "glyphfile.h"
+
+static const char MAGIC[8] = { 't', 'V', 'F', 'D', 'g', 'l', 'y', 'f' };
+
+cVFDGlyphFile::cVFDGlyphFile() {
+  map = NULL;
+  nMap = 0;
+  header = NULL;
+  fallbackKey = NULL;
+  pairs = NULL;
+  glyphs = NULL;
+  bitmaps = NULL;
+}
+
+cVFDGlyphFile::~cVFDGlyphFile() {
+  Unmap();
+}
+
+bool cVFDGlyphFile::Map(const char* FileName, const char* Key) {
+  Unmap();
+  int fd = open(FileName, O_RDONLY);
+  if(fd < 0)
+    return false; // not written yet
+  struct stat st;
+  if(fstat(fd, &st) == 0 && st.st_size >= (off_t) sizeof(tHeader)) {
+    nMap = st.st_size;
+    map = mmap(NULL, nMap, PROT_READ, MAP_SHARED, fd, 0);
+    if(map == MAP_FAILED) {
+      esyslog("targaVFD: can't map glyph cache %s: %s", FileName, strerror(errno));
+      map = NULL;
+    }
+  }
+  close(fd);
+  if(map && !Check(Key)) {
+    isyslog("targaVFD: glyph cache %s is outdated", FileName);
+    Unmap();
+  }
+  return Mapped();
+}
+
+/**
+ * Check key and bounds of a mapped file, sets pointers to its parts.
+ */
+bool cVFDGlyphFile::Check(const char* Key) {
+  const tHeader* h = (const tHeader*) map;
+  if(memcmp(h->magic, MAGIC, sizeof(MAGIC)) || h->nVersion != VERSION)
+    return false;
+  const char* p = ((const char*) map) + sizeof(tHeader);
+  const size_t nKey = strlen(Key) + 1;
+  if(h->nKey != nKey || h->nFallbackKey == 0 || h->nFallbackKey > 4096
+     || sizeof(tHeader) + Pad(nKey) + Pad(h->nFallbackKey) > nMap
+     || memcmp(p, Key, nKey))
+    return false;
+  p += Pad(nKey);
+  if(p[h->nFallbackKey - 1] != '\0')
+    return false;
+  const char* f = p;
+  p += Pad(h->nFallbackKey);
+  const size_t nSize = (p - (const char*) map)
+                     + (size_t) h->nPairs * sizeof(tPair)
+                     + (size_t) h->nGlyphs * sizeof(tGlyph)
+                     + h->nBitmaps;
+  if(nSize != nMap)
+    return false;
+  const tPair* kp = (const tPair*) p;
+  const tGlyph* g = (const tGlyph*) (kp + h->nPairs);
+  for(unsigned int i = 0; i < h->nGlyphs; ++i) {
+    if(g[i].width < 0 || g[i].rows < 0
+       || (i && g[i].charCode <= g[i - 1].charCode)
+       || (size_t) g[i].offset + (size_t) g[i].width * ((g[i].rows + 7) / 8) > h->nBitmaps)
+      return false;
+  }
+  header = h;
+  fallbackKey = f;
+  pairs = kp;
+  glyphs = g;
+  bitmaps = (const unsigned char*) (g + h->nGlyphs);
+  return true;
+}
+
+void cVFDGlyphFile::Unmap() {
+  if(map) {
+    munmap(map, nMap);
+    map = NULL;
+  }
+  nMap = 0;
+  header = NULL;
+  fallbackKey = NULL;
+  pairs = NULL;
+  glyphs = NULL;
+  bitmaps = NULL;
+}
+
+const cVFDGlyphFile::tGlyph* cVFDGlyphFile::Find(uint CharCode) const {
+  if(!header)
+    return NULL;
+  unsigned int lo = 0;
+  unsigned int hi = header->nGlyphs;
+  while(lo < hi) {
+    unsigned int mid = (lo + hi) / 2;
+    if(glyphs[mid].charCode < CharCode)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return (lo < header->nGlyphs && glyphs[lo].charCode == CharCode) ? &glyphs[lo] : NULL;
+}
+
+bool cVFDGlyphFile::Write(const char* FileName, const char* Key, const char* FallbackKey,
+                          int nHeight, int nBottom, bool bKerning,
+                          const tPair* Pairs, unsigned int nPairs,
+                          const tGlyph* Glyphs, unsigned int nGlyphs,
+                          const unsigned char* Bitmaps, unsigned int nBitmaps) {
+  tHeader h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, MAGIC, sizeof(MAGIC));
+  h.nVersion = VERSION;
+  h.nKey = strlen(Key) + 1;
+  h.nFallbackKey = strlen(FallbackKey) + 1;
+  h.nHeight = nHeight;
+  h.nBottom = nBottom;
+  h.bKerning = bKerning ? 1 : 0;
+  h.nPairs = nPairs;
+  h.nGlyphs = nGlyphs;
+  h.nBitmaps = nBitmaps;
+
+  // a reader maps either the old or the complete new file
+  cString sTemp = cString::sprintf("%s.%d", FileName, getpid());
+  FILE* f = fopen(sTemp, "w");
+  if(!f) {
+    esyslog("targaVFD: can't write glyph cache %s: %s", *sTemp, strerror(errno));
+    return false;
+  }
+  static const char zero[4] = { 0, 0, 0, 0 };
+  bool bOk = fwrite(&h, sizeof(h), 1, f) == 1
+          && fwrite(Key, h.nKey, 1, f) == 1
+          && fwrite(zero, Pad(h.nKey) - h.nKey, 1, f) <= 1
+          && fwrite(FallbackKey, h.nFallbackKey, 1, f) == 1
+          && fwrite(zero, Pad(h.nFallbackKey) - h.nFallbackKey, 1, f) <= 1
+          && fwrite(Pairs, sizeof(tPair), nPairs, f) == nPairs
+          && fwrite(Glyphs, sizeof(tGlyph), nGlyphs, f) == nGlyphs
+          && fwrite(Bitmaps, 1, nBitmaps, f) == nBitmaps;
+  if(fclose(f))
+    bOk = false;
+  if(bOk && rename(sTemp, FileName))
+    bOk = false;
+  if(!bOk) {
+    esyslog("targaVFD: can't write glyph cache %s: %s", FileName, strerror(errno));
+    unlink(sTemp);
+  }
+  return bOk;
+}
@@ -0,0 +1,106 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#ifndef __VFD_GLYPHFILE_H___
+#define __VFD_GLYPHFILE_H___
+
+#include <sys/types.h>
+#include <stdint.h>
+
+/*
+ * Rendered glyphs and kerning of a font, stored in a file and
+ * mapped read-only. The file is keyed by path, time of modification
+ * and size of font file and the requested size of characters.
+ *
+ * Layout: header, key, fallback key (each padded to 4 bytes),
+ * kerning pairs, glyphs sorted by character, bitmaps.
+ */
+class cVFDGlyphFile {
+public:
+  enum { VERSION = 1 };
+  enum eFlags {
+    eFlagFallback = 1 << 0,  ///< rendered by a fallback font
+    eFlagMissing  = 1 << 1   ///< no font has this character
+  };
+  struct tHeader {
+    char     magic[8];
+    uint32_t nVersion;
+    uint32_t nKey;          ///< bytes of key, incl. terminating zero
+    uint32_t nFallbackKey;  ///< bytes of fallback key, incl. terminating zero
+    int32_t  nHeight;
+    int32_t  nBottom;
+    uint32_t bKerning;
+    uint32_t nPairs;
+    uint32_t nGlyphs;
+    uint32_t nBitmaps;      ///< bytes of all bitmaps
+  };
+  struct tPair {
+    uint32_t prevSym;
+    uint32_t sym;
+    int32_t  kerning;
+  };
+  struct tGlyph {
+    uint32_t charCode;
+    int32_t  advanceX;
+    int32_t  advanceY;
+    int32_t  left;
+    int32_t  top;
+    int32_t  width;
+    int32_t  rows;
+    uint32_t flags;         ///< see eFlags
+    uint32_t offset;        ///< first byte of bitmap, within bitmaps
+  };
+private:
+  void* map;
+  size_t nMap;
+  const tHeader* header;
+  const char* fallbackKey;
+  const tPair* pairs;
+  const tGlyph* glyphs;
+  const unsigned char* bitmaps;
+
+  static size_t Pad(size_t n) { return (n + 3) & ~((size_t) 3); }
+  bool Check(const char* Key);
+public:
+  cVFDGlyphFile();
+  virtual ~cVFDGlyphFile();
+
+  /** map a file, false if it's missing, damaged or was written for another key */
+  bool Map(const char* FileName, const char* Key);
+  void Unmap();
+  bool Mapped() const { return header != NULL; }
+
+  int Height() const { return header->nHeight; }
+  int Bottom() const { return header->nBottom; }
+  bool Kerning() const { return header->bKerning != 0; }
+  const char* FallbackKey() const { return fallbackKey; }
+  unsigned int Pairs() const { return header->nPairs; }
+  const tPair& Pair(unsigned int n) const { return pairs[n]; }
+  unsigned int Glyphs() const { return header->nGlyphs; }
+  const tGlyph& Glyph(unsigned int n) const { return glyphs[n]; }
+  /** glyph of a character, NULL if it's not stored */
+  const tGlyph* Find(uint CharCode) const;
+  const unsigned char* Bitmap(const tGlyph& g) const { return bitmaps + g.offset; }
+
+  /**
+   * Write a file by a temporary file, which is renamed at last.
+   * Glyphs must be sorted by character.
+   */
+  static bool Write(const char* FileName, const char* Key, const char* FallbackKey,
+                    int nHeight, int nBottom, bool bKerning,
+                    const tPair* Pairs, unsigned int nPairs,
+                    const tGlyph* Glyphs, unsigned int nGlyphs,
+                    const unsigned char* Bitmaps, unsigned int nBitmaps);
+};
+
+#endif
@@ -0,0 +1,225 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <dirent.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/file.h>
+#include <vdr/tools.h>
+
+#include "hidraw.h"
+#include "mdm166a.h"
+
+static const char* SYSFS_HIDRAW = "/sys/class/hidraw";
+
+// Report number ahead of report, the display don't use numbered reports
+static const unsigned char HIDRAW_REPORT_ID = 0x00;
+
+typedef char HeadroomCheck[(cVFDPacket::HEADROOM >= 1) ? 1 : -1];
+
+// Frames in a row, which miss their deadline, until the node is reopened
+static const unsigned int MISSED_REOPEN = 3;
+
+cVFDTransportHidraw::cVFDTransportHidraw(const cVFDDriver* pDriver, const char* szDevice, int nDeadlineMs)
+: cVFDTransport(pDriver)
+, sDevice(szDevice) {
+  fd = -1;
+  nDeadline = nDeadlineMs;
+  nMissed = 0;
+}
+
+cVFDTransportHidraw::~cVFDTransportHidraw() {
+  cVFDTransportHidraw::close();
+}
+
+/**
+ * Look at sysfs, if a hidraw node belongs to the display. If a device 
+ * is selected, its bus/port has to be part of the sysfs path of the node,
+ * or its serial number has to match.
+ * \param szEntry  name of node, like hidraw0
+ */
+bool cVFDTransportHidraw::Match(const char* szEntry) const {
+
+  char szMatch[32];
+  snprintf(szMatch, sizeof(szMatch), "HID_ID=0003:%08X:%08X", VENDOR_ID, PRODUCT_ID);
+
+  char szUEvent[PATH_MAX];
+  snprintf(szUEvent, sizeof(szUEvent), "%s/%s/device/uevent", SYSFS_HIDRAW, szEntry);
+  FILE* f = fopen(szUEvent, "r");
+  if(!f)
+    return false;
+
+  bool bFound = false;
+  char szSerial[64] = "";
+  char szLine[256];
+  while(fgets(szLine, sizeof(szLine), f)) {
+    if(!strncasecmp(szLine, szMatch, strlen(szMatch))) {
+      bFound = true;
+    } else if(!strncmp(szLine, "HID_UNIQ=", 9)) {
+      strn0cpy(szSerial, szLine + 9, sizeof(szSerial));
+      szSerial[strcspn(szSerial, "\r\n")] = '\0';
+    }
+  }
+  fclose(f);
+
+  if(!bFound || isempty(*sDevice))
+    return bFound;
+  if(!strcmp(*sDevice, szSerial))
+    return true;
+
+  // e.g. /sys/devices/pci0000:00/0000:00:14.0/usb3/3-1/3-1.2/3-1.2:1.0/0003:19C2:6A11.0004
+  char szLink[PATH_MAX];
+  char szPath[PATH_MAX];
+  snprintf(szLink, sizeof(szLink), "%s/%s/device", SYSFS_HIDRAW, szEntry);
+  if(!realpath(szLink, szPath))
+    return false;
+  cString sPort = cString::sprintf("/%s:", *sDevice);
+  return strstr(szPath, *sPort) != NULL;
+}
+
+bool cVFDTransportHidraw::open() {
+
+  dsyslog("targaVFD: scanning hidraw for Futaba MDM166A...");
+  DIR* d = opendir(SYSFS_HIDRAW);
+  if(!d) {
+    esyslog("targaVFD: Unable to find the device, %s not present!", SYSFS_HIDRAW);
+    return false;
+  }
+
+  char szNode[64];
+  struct dirent* e;
+  while(fd < 0 && (e = readdir(d)) != NULL) {
+    if(strncmp(e->d_name, "hidraw", 6) || !Match(e->d_name))
+      continue;
+
+    snprintf(szNode, sizeof(szNode), "/dev/%s", e->d_name);
+    fd = ::open(szNode, O_WRONLY | O_CLOEXEC);
+    if(fd < 0) {
+      esyslog("targaVFD: Unable to open %s! %s (%d)", szNode, strerror(errno), errno);
+      continue;
+    }
+    // hidraw can opened twice, the lock keep another unit away
+    if(flock(fd, LOCK_EX | LOCK_NB) < 0) {
+      dsyslog("targaVFD: %s already in use", szNode);
+      ::close(fd);
+      fd = -1;
+    }
+  }
+  closedir(d);
+
+  if(fd < 0) {
+    esyslog("targaVFD: Unable to find the device at hidraw!");
+    return false;
+  }
+  dsyslog("targaVFD: using %s", szNode);
+  packet->clear();
+  nMissed = 0;
+  return true;
+}
+
+void cVFDTransportHidraw::close() {
+  if(fd >= 0) {
+    ::close(fd);
+    fd = -1;
+  }
+}
+
+bool cVFDTransportHidraw::Flush() {
+
+  if(packet->empty())
+    return true;
+  if(!isopen()) {
+    packet->clear();
+    return false;
+  }
+
+  cTimeMs tsFrame;
+  for(unsigned int i = 0; i < packet->Reports(); ++i) {
+    // report number is written into headroom, just before length byte
+    unsigned char* report = packet->Report(i) - 1;
+    *report = HIDRAW_REPORT_ID;
+    ssize_t n = packet->ReportLength(i) + 1;
+
+    // all reports of a frame share the deadline
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLOUT;
+    pfd.revents = 0;
+    int ready;
+    do {
+      ready = ::poll(&pfd, 1, max(nDeadline - (int)tsFrame.Elapsed(), 1));
+    } while(ready < 0 && errno == EINTR);
+
+    if(ready == 0) {
+      packet->clear();
+      bResync = true; // the frame was dropped
+      Escalate();
+      return false;
+    }
+    if(ready < 0 || (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))) {
+      esyslog("targaVFD: poll of hidraw failed : %s (%d)", 
+              ready < 0 ? strerror(errno) : "device gone", ready < 0 ? errno : pfd.revents);
+      packet->clear();
+      cVFDTransportHidraw::close();
+      return false;
+    }
+
+    ssize_t bytes;
+    do {
+      bytes = ::write(fd, report, n);
+    } while(bytes < 0 && errno == EINTR);
+
+    if(bytes != n) {
+      esyslog("targaVFD: write to hidraw failed : %s (%d)", 
+              bytes < 0 ? strerror(errno) : "short write", bytes < 0 ? errno : (int)bytes);
+      packet->clear();
+      cVFDTransportHidraw::close();
+      return false;
+    }
+  }
+  FrameQueued(packet->Reports());
+  FrameDone(nFrameQueued);
+  packet->clear();
+
+  // the node reports always writable, a slow display blocks the write itself.
+  // That's done by the transport thread of the display, the render thread
+  // skips the display meanwhile, and the late frame is accounted here.
+  if((int)tsFrame.Elapsed() > nDeadline)
+    Escalate();
+  else
+    nMissed = 0;
+  return true;
+}
+
+/**
+ * A frame missed its deadline, the display is probably wedged.
+ * Reports, which are queued by kernel, can't be cancelled. If
+ * frames miss their deadline in a row, the node is reopened.
+ */
+void cVFDTransportHidraw::Escalate() {
+
+  ++stat.nDeadlineMissed;
+  if(++nMissed < MISSED_REOPEN) {
+    isyslog("targaVFD: frame missed deadline of %d ms", nDeadline);
+    return;
+  }
+  esyslog("targaVFD: display still wedged, reopen hidraw");
+  ++stat.nReopen;
+  nMissed = 0;
+  bResync = true;
+  cVFDTransportHidraw::close();
+}
@@ -0,0 +1,47 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#ifndef __VFD_HIDRAW_H___
+#define __VFD_HIDRAW_H___
+
+#include <vdr/tools.h>
+#include "transport.h"
+
+/*
+ * Transport by the hidraw node of kernel's HID driver,
+ * without detaching the driver. Each report is one write(),
+ * which blocks until the kernel has sent it.
+ */
+class cVFDTransportHidraw : public cVFDTransport {
+  int fd;
+  cString sDevice;  ///< selected bus/port or serial number, empty for any
+
+  /* watchdog, see Escalate() */
+  int nDeadline;          ///< deadline of a frame, in ms
+  unsigned int nMissed;   ///< frames in a row, which missed their deadline
+
+  bool Match(const char* szEntry) const;
+  void Escalate();
+public:
+  cVFDTransportHidraw(const cVFDDriver* pDriver, const char* szDevice, int nDeadlineMs);
+  virtual ~cVFDTransportHidraw();
+
+  virtual const char* Name() const { return "hidraw"; }
+  virtual bool open();
+  virtual void close();
+  virtual bool isopen() const { return fd >= 0; }
+  virtual bool Blocking() const { return true; }
+  virtual bool Flush();
+};
+
+#endif
@@ -0,0 +1,96 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#include <string.h>
+#include "kerning.h"
+
+cVFDKerningTable::cVFDKerningTable() {
+  pairs = NULL;
+  nSize = 0;
+  nUsed = 0;
+}
+
+cVFDKerningTable::~cVFDKerningTable() {
+  clear();
+}
+
+void cVFDKerningTable::clear() {
+  if(pairs) {
+    delete[] pairs;
+    pairs = NULL;
+  }
+  nSize = 0;
+  nUsed = 0;
+}
+
+unsigned int cVFDKerningTable::Hash(uint PrevSym, uint Sym) {
+  return (PrevSym * 2654435761U) ^ (Sym * 40503U);
+}
+
+bool cVFDKerningTable::Lookup(uint PrevSym, uint Sym, int& Kerning) const {
+  if(!nUsed)
+    return false;
+  for(unsigned int i = Hash(PrevSym, Sym) & (nSize - 1);; i = (i + 1) & (nSize - 1)) {
+    const tPair& p = pairs[i];
+    if(!p.sym)
+      return false;
+    if(p.sym == Sym && p.prevSym == PrevSym) {
+      Kerning = p.kerning;
+      return true;
+    }
+  }
+}
+
+void cVFDKerningTable::Insert(uint PrevSym, uint Sym, int Kerning) {
+  if(!Sym)
+    return;
+  // keep at least a quarter of slots empty
+  if((nUsed + 1) * 4 > nSize * 3)
+    Grow();
+  for(unsigned int i = Hash(PrevSym, Sym) & (nSize - 1);; i = (i + 1) & (nSize - 1)) {
+    tPair& p = pairs[i];
+    if(!p.sym) {
+      p.prevSym = PrevSym;
+      p.sym = Sym;
+      p.kerning = Kerning;
+      ++nUsed;
+      return;
+    }
+    if(p.sym == Sym && p.prevSym == PrevSym) {
+      p.kerning = Kerning;
+      return;
+    }
+  }
+}
+
+void cVFDKerningTable::Grow() {
+  tPair* old = pairs;
+  unsigned int nOld = nSize;
+  nSize = nSize ? nSize * 2 : 64;
+  pairs = new tPair[nSize];
+  memset(pairs, 0, sizeof(tPair) * nSize);
+  nUsed = 0;
+  for(unsigned int i = 0; i < nOld; ++i)
+    if(old[i].sym)
+      Insert(old[i].prevSym, old[i].sym, old[i].kerning);
+  delete[] old;
+}
+
+bool cVFDKerningTable::Slot(unsigned int n, uint& PrevSym, uint& Sym, int& Kerning) const {
+  if(n >= nSize || !pairs[n].sym)
+    return false;
+  PrevSym = pairs[n].prevSym;
+  Sym = pairs[n].sym;
+  Kerning = pairs[n].kerning;
+  return true;
+}
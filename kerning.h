@@ -0,0 +1,52 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#ifndef __VFD_KERNING_H___
+#define __VFD_KERNING_H___
+
+#include <sys/types.h>
+
+/*
+ * Kerning of character pairs, hashed by open addressing.
+ * Only pairs with a kerning, or looked up on demand, are stored.
+ */
+class cVFDKerningTable {
+  struct tPair {
+    uint prevSym;
+    uint sym;      ///< 0 marks an empty slot
+    int  kerning;
+  };
+  tPair* pairs;
+  unsigned int nSize;   ///< count of slots, power of two
+  unsigned int nUsed;
+
+  static unsigned int Hash(uint PrevSym, uint Sym);
+  void Grow();
+public:
+  cVFDKerningTable();
+  virtual ~cVFDKerningTable();
+
+  void clear();
+  /** true, if pair is known */
+  bool Lookup(uint PrevSym, uint Sym, int& Kerning) const;
+  void Insert(uint PrevSym, uint Sym, int Kerning);
+  unsigned int Count() const { return nUsed; }
+  /** count of slots, see Slot() */
+  unsigned int Slots() const { return nSize; }
+  /** pair of a slot, false if it's empty */
+  bool Slot(unsigned int n, uint& PrevSym, uint& Sym, int& Kerning) const;
+  /** bytes of slots */
+  unsigned long Bytes() const { return nSize * sizeof(tPair); }
+};
+
+#endif
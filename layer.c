@@ -0,0 +1,85 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#include "layer.h"
+
+cVFDLayer::cVFDLayer() {
+  bitmap = NULL;
+  bKey = false;
+}
+
+cVFDLayer::~cVFDLayer() {
+  Destroy();
+}
+
+cVFDLayer& cVFDLayer::operator = (const cVFDLayer& x) {
+  if(this == &x)
+    return *this;
+  if(!x.bitmap) {
+    Destroy();
+    return *this;
+  }
+  if(!bitmap)
+    bitmap = new cVFDBitmap(x.bitmap->Width(), x.bitmap->Height());
+  *bitmap = *x.bitmap;
+  sKey = x.sKey;
+  bKey = x.bKey;
+  return *this;
+}
+
+bool cVFDLayer::Create(int width, int height) {
+  Destroy();
+  bitmap = new cVFDBitmap(width, height);
+  if(!bitmap || !bitmap->getBitmap())
+    return false;
+  bitmap->ClearDamage();
+  return true;
+}
+
+void cVFDLayer::Destroy() {
+  if(bitmap) {
+    delete bitmap;
+    bitmap = NULL;
+  }
+  bKey = false;
+}
+
+void cVFDLayer::Bounds(int x1, int y1, int x2, int y2) {
+  if(!bitmap)
+    return;
+  bitmap->ResetClip();
+  bitmap->PushClip(x1, y1, x2, y2);
+}
+
+bool cVFDLayer::Changed(const char* szKey) {
+  if(!szKey)
+    szKey = "";
+  if(bKey && !strcmp(*sKey, szKey))
+    return false;
+  sKey = cString(szKey);
+  bKey = true;
+  return true;
+}
+
+void cVFDLayer::clear() {
+  if(bitmap)
+    bitmap->clear();
+}
+
+void cVFDLayer::Reset() {
+  if(bitmap) {
+    bitmap->ResetClip();
+    bitmap->clear();
+  }
+  bKey = false;
+}
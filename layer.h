@@ -0,0 +1,51 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#ifndef __VFD_LAYER_H___
+#define __VFD_LAYER_H___
+
+#include <vdr/tools.h>
+#include "bitmap.h"
+
+/*
+ * Separately drawn part of the screen, e.g. header or body. The layer
+ * remembers what it shows by a key, so it's only drawn again if the key
+ * changes. Damaged columns of all layers are composed into the framebuffer.
+ */
+class cVFDLayer {
+  cVFDBitmap* bitmap;
+  cString sKey;          ///< shown content, empty after clear
+  bool bKey;
+public:
+  cVFDLayer();
+  virtual ~cVFDLayer();
+  /** copy pixels, bounds and key, all columns are damaged */
+  cVFDLayer& operator = (const cVFDLayer& x);
+
+  bool Create(int width, int height);
+  void Destroy();
+
+  cVFDBitmap* Bitmap() const { return bitmap; }
+  /** restrict drawing to bounds, until Bounds() is set again */
+  void Bounds(int x1, int y1, int x2, int y2);
+  /** true, if layer has to be drawn again to show content of key */
+  bool Changed(const char* szKey);
+  /** remove all pixels, keeps key */
+  void clear();
+  /** remove all pixels and key, bounds are whole screen */
+  void Reset();
+  /** columns changed since last compose */
+  bool Damaged() const { return bitmap && bitmap->Damaged(); }
+};
+
+#endif
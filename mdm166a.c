@@ -0,0 +1,71 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#include "mdm166a.h"
+
+static inline unsigned char toBCD(int x) {
+  return (unsigned char)(((x) / 10 * 16) + ((x) % 10));
+}
+
+unsigned int cVFDDriverMDM166A::EncodeReset(unsigned char* buf) const {
+  buf[0] = CMD_PREFIX;
+  buf[1] = CMD_RESET;
+  return 2;
+}
+
+unsigned int cVFDDriverMDM166A::EncodeDimm(unsigned char* buf, int nLevel) const {
+  buf[0] = CMD_PREFIX;
+  buf[1] = CMD_SETDIMM;
+  buf[2] = (unsigned char) nLevel;
+  return 3;
+}
+
+unsigned int cVFDDriverMDM166A::EncodeSymbol(unsigned char* buf, unsigned int nSymbol, bool bOn) const {
+  buf[0] = CMD_PREFIX;
+  buf[1] = CMD_SETSYMBOL;
+  buf[2] = (unsigned char) nSymbol;
+  buf[3] = bOn ? STATE_ON : STATE_OFF;
+  return 4;
+}
+
+/**
+ * Count is a single byte, address too if the whole RAM fits into 256 bytes
+ * like the 192 bytes of the MDM166A, otherwise two bytes, low byte first.
+ */
+unsigned int cVFDDriverMDM166A::EncodeWrite(unsigned char* buf, unsigned int nAddress, unsigned int nBytes) const {
+  unsigned int n = 0;
+  buf[n++] = CMD_PREFIX;
+  buf[n++] = CMD_SETRAM;
+  buf[n++] = (unsigned char) nAddress;
+  if(AddressBytes(width * SizeYb()) > 1)
+    buf[n++] = (unsigned char) (nAddress >> 8);
+  buf[n++] = CMD_PREFIX;
+  buf[n++] = CMD_SETPIXEL;
+  buf[n++] = (unsigned char) nBytes;
+  return n;
+}
+
+unsigned int cVFDDriverMDM166A::EncodeSetClock(unsigned char* buf, int nHour, int nMinute) const {
+  buf[0] = CMD_PREFIX;
+  buf[1] = CMD_SETCLOCK;
+  buf[2] = toBCD(nMinute);
+  buf[3] = toBCD(nHour);
+  return 4;
+}
+
+unsigned int cVFDDriverMDM166A::EncodeShowClock(unsigned char* buf) const {
+  buf[0] = CMD_PREFIX;
+  buf[1] = CMD_BIGCLOCK;
+  buf[2] = TIME_24;
+  return 3;
+}
@@ -0,0 +1,106 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#ifndef __VFD_MDM166A_H___
+#define __VFD_MDM166A_H___
+
+#include "driver.h"
+
+// Defines from display datasheet
+static const int VENDOR_ID = 0x019c2;
+static const int PRODUCT_ID = 0x06a11;
+
+static const unsigned int RAM_WIDTH        = 96;   //Columns of graphics RAM
+static const unsigned int RAM_HEIGHT       = 16;   //Rows of graphics RAM
+
+static const unsigned char ICON_PLAY       = 0x00; //Play
+static const unsigned char ICON_PAUSE      = 0x01; //Pause
+static const unsigned char ICON_RECORD     = 0x02; //Record
+static const unsigned char ICON_MESSAGE    = 0x03; //Message symbol (without the inner @)
+static const unsigned char ICON_MSGAT      = 0x04; //Message @
+static const unsigned char ICON_MUTE       = 0x05; //Mute
+static const unsigned char ICON_WLAN1      = 0x06; //WLAN (tower base)
+static const unsigned char ICON_WLAN2      = 0x07; //WLAN strength (1 of 3)
+static const unsigned char ICON_WLAN3      = 0x08; //WLAN strength (2 of 3)
+static const unsigned char ICON_WLAN4      = 0x09; //WLAN strength (3 of 3)
+static const unsigned char ICON_VOLUME     = 0x0A; //Volume (the word)
+static const unsigned char ICON_VOL1       = 0x0B; //Volume level 1 of 14
+static const unsigned char ICON_VOL2       = 0x0C; //Volume level 2 of 14
+static const unsigned char ICON_VOL3       = 0x0D; //Volume level 3 of 14
+static const unsigned char ICON_VOL4       = 0x0E; //Volume level 4 of 14
+static const unsigned char ICON_VOL5       = 0x0F; //Volume level 5 of 14
+static const unsigned char ICON_VOL6       = 0x10; //Volume level 6 of 14
+static const unsigned char ICON_VOL7       = 0x11; //Volume level 7 of 14
+static const unsigned char ICON_VOL8       = 0x12; //Volume level 8 of 14
+static const unsigned char ICON_VOL9       = 0x13; //Volume level 9 of 14
+static const unsigned char ICON_VOL10      = 0x14; //Volume level 10 of 14
+static const unsigned char ICON_VOL11      = 0x15; //Volume level 11 of 14
+static const unsigned char ICON_VOL12      = 0x16; //Volume level 12 of 14
+static const unsigned char ICON_VOL13      = 0x17; //Volume level 13 of 14
+static const unsigned char ICON_VOL14      = 0x18; //Volume level 14 of 14
+
+static const unsigned char STATE_OFF       = 0x00; //Symbol off
+static const unsigned char STATE_ON        = 0x01; //Symbol on
+static const unsigned char STATE_ONHIGH    = 0x02; //Symbol on, high intensity, can only be used with the volume symbols
+
+static const unsigned char CMD_PREFIX      = 0x1b;
+static const unsigned char CMD_SETCLOCK    = 0x00; //Actualize the time of the display
+static const unsigned char CMD_SMALLCLOCK  = 0x01; //Display small clock on display
+static const unsigned char CMD_BIGCLOCK    = 0x02; //Display big clock on display
+static const unsigned char CMD_SETSYMBOL   = 0x30; //Enable or disable symbol
+static const unsigned char CMD_SETDIMM     = 0x40; //Set the dimming level of the display
+static const unsigned char CMD_RESET       = 0x50; //Reset all configuration data to default and clear
+static const unsigned char CMD_SETRAM      = 0x60; //Set the actual graphics RAM offset for next data write
+static const unsigned char CMD_SETPIXEL    = 0x70; //Write pixel data to RAM of the display
+static const unsigned char CMD_TEST1       = 0xf0; //Show vertical test pattern
+static const unsigned char CMD_TEST2       = 0xf1; //Show horizontal test pattern
+
+static const unsigned char TIME_12         = 0x00; //12 hours format
+static const unsigned char TIME_24         = 0x01; //24 hours format
+
+static const unsigned char BRIGHT_OFF      = 0x00; //Display off
+static const unsigned char BRIGHT_DIMM     = 0x01; //Display dimmed
+static const unsigned char BRIGHT_FULL     = 0x02; //Display full brightness
+
+/*
+ * Futaba MDM166A, 96x16 pixel and 25 symbols. Larger panels with the
+ * same command set address their RAM by two bytes.
+ */
+class cVFDDriverMDM166A : public cVFDDriver {
+  unsigned int width;
+  unsigned int height;
+public:
+  cVFDDriverMDM166A(unsigned int nWidth = RAM_WIDTH, unsigned int nHeight = RAM_HEIGHT)
+  : width(nWidth), height(nHeight) {}
+
+  /** bytes of the address of CMD_SETRAM, for a RAM of nRamSize bytes */
+  static unsigned int AddressBytes(unsigned int nRamSize) { return nRamSize > 256 ? 2 : 1; }
+
+  virtual const char* Name() const { return width == RAM_WIDTH && height == RAM_HEIGHT ? "Futaba MDM166A" : "MDM166A compatible"; }
+  virtual unsigned int Width() const { return width; }
+  virtual unsigned int Height() const { return height; }
+  virtual unsigned int Symbols() const { return ICON_VOL14 + 1; }
+  virtual int DimmMax() const { return BRIGHT_FULL; }
+  virtual int DimmReset() const { return BRIGHT_FULL; }
+  virtual unsigned int WriteHeader() const { return 5 + AddressBytes(width * SizeYb()); }
+  virtual unsigned int MaxWrite() const { return 255; }
+
+  virtual unsigned int EncodeReset(unsigned char* buf) const;
+  virtual unsigned int EncodeDimm(unsigned char* buf, int nLevel) const;
+  virtual unsigned int EncodeSymbol(unsigned char* buf, unsigned int nSymbol, bool bOn) const;
+  virtual unsigned int EncodeWrite(unsigned char* buf, unsigned int nAddress, unsigned int nBytes) const;
+  virtual unsigned int EncodeSetClock(unsigned char* buf, int nHour, int nMinute) const;
+  virtual unsigned int EncodeShowClock(unsigned char* buf) const;
+};
+
+#endif
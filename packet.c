@@ -0,0 +1,94 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#include <string.h>
+#include "packet.h"
+
+cVFDPacket::cVFDPacket() {
+  buffer = NULL;
+  nCapacity = 0;
+  clear();
+}
+
+cVFDPacket::~cVFDPacket() {
+  delete[] buffer;
+}
+
+/**
+ * Allocate the reports for a frame.
+ * \param nBytes  worst case command stream of a frame, at least MIN_REPORTS are held.
+ */
+bool cVFDPacket::Create(unsigned int nBytes) {
+  unsigned int n = (nBytes + PAYLOAD - 1) / PAYLOAD;
+  if(n < MIN_REPORTS)
+    n = MIN_REPORTS;
+  delete[] buffer;
+  buffer = new unsigned char[n][SLOTSIZE];
+  nCapacity = buffer ? n : 0;
+  clear();
+  return buffer != NULL;
+}
+
+/**
+ * Discard all reports.
+ */
+void cVFDPacket::clear() {
+  nReports = 0;
+  len = NULL;
+  pos = NULL;
+  end = NULL;
+}
+
+/**
+ * Start next report.
+ * \retval false   capacity of builder exhausted.
+ */
+bool cVFDPacket::NextReport() {
+  if(nReports >= nCapacity)
+    return false;
+  len = buffer[nReports] + HEADROOM;
+  *len = 0;
+  pos = len + 1;
+  end = pos + PAYLOAD;
+  ++nReports;
+  return true;
+}
+
+/**
+ * Count of queued bytes, without length bytes.
+ */
+unsigned int cVFDPacket::size() const {
+  if(!nReports)
+    return 0;
+  return ((nReports - 1) * PAYLOAD) + *len;
+}
+
+/**
+ * Append a block of data, split at report boundaries.
+ * \return count of written bytes.
+ */
+unsigned int cVFDPacket::push(const unsigned char* p, unsigned int n) {
+  unsigned int written = 0;
+  while(written < n) {
+    if(pos == end && !NextReport())
+      break;
+    unsigned int c = end - pos;
+    if(c > n - written)
+      c = n - written;
+    memcpy(pos, p + written, c);
+    pos += c;
+    *len += c;
+    written += c;
+  }
+  return written;
+}
@@ -0,0 +1,71 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#ifndef __VFD_PACKET_H___
+#define __VFD_PACKET_H___
+
+/*
+ * Builder of HID output reports, sized once for a complete frame of the
+ * panel. Commands and data are written directly into preformatted report
+ * buffers, so they can be handed to the transport without further copy.
+ *
+ * Each slot holds : [headroom][length][payload ...]
+ */
+class cVFDPacket {
+public:
+  static const unsigned int PAYLOAD = 63;     ///< payload of a report, without length byte
+  static const unsigned int HEADROOM = 8;     ///< reserved ahead each report, e.g. for control setup packet
+  static const unsigned int MIN_REPORTS = 16; ///< least capacity of the builder
+  static const unsigned int SLOTSIZE = HEADROOM + 1 + PAYLOAD;
+private:
+  unsigned char (*buffer)[SLOTSIZE];
+  unsigned int nCapacity;
+  unsigned int nReports;
+  unsigned char* len;   ///< length byte of current report
+  unsigned char* pos;   ///< write position within current report
+  unsigned char* end;   ///< end of current report
+
+  bool NextReport();
+public:
+  cVFDPacket();
+  ~cVFDPacket();
+
+  bool Create(unsigned int nBytes);
+  /** count of reports, which the builder can hold */
+  unsigned int Capacity() const { return nCapacity; }
+
+  void clear();
+  bool empty() const { return nReports == 0; }
+  bool full() const { return pos == end && nReports == nCapacity; }
+  unsigned int size() const;
+
+  inline bool push(unsigned char c) {
+    if(pos == end && !NextReport())
+      return false;
+    *pos++ = c;
+    ++(*len);
+    return true;
+  }
+  unsigned int push(const unsigned char* p, unsigned int n);
+
+  /** count of reports, which are produced for this frame */
+  unsigned int Reports() const { return nReports; }
+  /** report i, starting with length byte */
+  unsigned char* Report(unsigned int i) { return buffer[i] + HEADROOM; }
+  /** length of report i, including length byte */
+  int ReportLength(unsigned int i) const { return buffer[i][HEADROOM] + 1; }
+  /** report i, including headroom */
+  unsigned char* Slot(unsigned int i) { return buffer[i]; }
+};
+
+#endif
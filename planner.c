@@ -0,0 +1,126 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#include "planner.h"
+#include "packet.h"
+
+cVFDPlanner::cVFDPlanner() {
+  clear(1, 0, 1);
+}
+
+void cVFDPlanner::clear(unsigned int sizeYb, unsigned int nHeader, unsigned int nMax) {
+  nRuns = 0;
+  nSpans = 0;
+  nSizeYb = sizeYb;
+  nWriteHeader = nHeader;
+  nMaxWrite = nMax > sizeYb ? nMax : sizeYb;  // a single column always fits
+}
+
+void cVFDPlanner::Dirty(unsigned int x) {
+  if(nRuns && runs[nRuns - 1].maxX > x) {
+    return;                   // already marked
+  } else if(nRuns && runs[nRuns - 1].maxX == x) {
+    ++runs[nRuns - 1].maxX;   // continue current run
+  } else if(nRuns < MAX_SPANS) {
+    runs[nRuns].minX = x;
+    runs[nRuns].maxX = x + 1;
+    ++nRuns;
+  } else {
+    runs[nRuns - 1].maxX = x + 1;  // out of runs, extend last one
+  }
+}
+
+void cVFDPlanner::Dirty(unsigned int minX, unsigned int maxX) {
+  if(nRuns && runs[nRuns - 1].maxX >= minX) {
+    if(runs[nRuns - 1].maxX < maxX)
+      runs[nRuns - 1].maxX = maxX;  // continue current run
+  } else if(nRuns < MAX_SPANS) {
+    runs[nRuns].minX = minX;
+    runs[nRuns].maxX = maxX;
+    ++nRuns;
+  } else {
+    runs[nRuns - 1].maxX = maxX;    // out of runs, extend last one
+  }
+}
+
+unsigned int cVFDPlanner::Reports(unsigned int nBytes) {
+  return (nBytes + cVFDPacket::PAYLOAD - 1) / cVFDPacket::PAYLOAD;
+}
+
+unsigned int cVFDPlanner::Bytes() const {
+  unsigned int n = 0;
+  for(unsigned int i = 0; i < nSpans; ++i)
+    n += Cost(spans[i].minX, spans[i].maxX);
+  return n;
+}
+
+unsigned int cVFDPlanner::Plan(unsigned int nQueued) {
+
+  nSpans = 0;
+  if(!nRuns)
+    return 0;
+
+  // cheapest partition of runs into writes, best[j] covers runs [0, j)
+  unsigned int best[MAX_SPANS + 1];
+  unsigned int from[MAX_SPANS + 1];
+  best[0] = 0;
+  for(unsigned int j = 1; j <= nRuns; ++j) {
+    best[j] = (unsigned int) -1;
+    for(unsigned int i = j; i-- > 0;) {
+      // a single run is always a candidate, even if it needs several writes
+      if(i + 1 < j && !Mergeable(runs[i].minX, runs[j - 1].maxX))
+        break;
+      unsigned int c = best[i] + Cost(runs[i].minX, runs[j - 1].maxX);
+      if(c < best[j]) {
+        best[j] = c;
+        from[j] = i;
+      }
+    }
+  }
+  // walk back the chosen writes
+  for(unsigned int j = nRuns; j > 0; j = from[j])
+    ++nSpans;
+  unsigned int n = nSpans;
+  for(unsigned int j = nRuns; j > 0; j = from[j]) {
+    --n;
+    spans[n].minX = runs[from[j]].minX;
+    spans[n].maxX = runs[j - 1].maxX;
+  }
+
+  // merge writes, as long as this don't need another report
+  unsigned int nBytes = nQueued + best[nRuns];
+  const unsigned int nReports = Reports(nBytes);
+  while(nSpans > 1) {
+    // cheapest neighbours, the gap between them is written again
+    unsigned int k = nSpans;
+    unsigned int nExtra = 0;
+    for(unsigned int i = 0; i + 1 < nSpans; ++i) {
+      if(!Mergeable(spans[i].minX, spans[i + 1].maxX))
+        continue;
+      unsigned int nGap = (spans[i + 1].minX - spans[i].maxX) * nSizeYb;
+      unsigned int e = nGap > nWriteHeader ? nGap - nWriteHeader : 0;
+      if(k == nSpans || e < nExtra) {
+        k = i;
+        nExtra = e;
+      }
+    }
+    if(k == nSpans || Reports(nBytes + nExtra) > nReports)
+      break;
+    spans[k].maxX = spans[k + 1].maxX;
+    for(unsigned int i = k + 1; i + 1 < nSpans; ++i)
+      spans[i] = spans[i + 1];
+    --nSpans;
+    nBytes += nExtra;
+  }
+  return nSpans;
+}
@@ -0,0 +1,71 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#ifndef __VFD_PLANNER_H___
+#define __VFD_PLANNER_H___
+
+/*
+ * Columns [minX, maxX), which are written by one SETRAM+SETPIXEL command
+ */
+struct cVFDSpan {
+  unsigned int minX;
+  unsigned int maxX;
+};
+
+/*
+ * Plan the writes of a partial refresh. Runs of changed columns are
+ * merged, if rewriting the unchanged columns between them is cheaper 
+ * than the header of another write. Afterwards writes are merged as long
+ * as they still fit into the same count of reports.
+ */
+class cVFDPlanner {
+public:
+  static const unsigned int MAX_SPANS = 128;
+private:
+  cVFDSpan runs[MAX_SPANS];
+  unsigned int nRuns;
+  cVFDSpan spans[MAX_SPANS];
+  unsigned int nSpans;
+  unsigned int nSizeYb;
+  unsigned int nWriteHeader;  ///< bytes ahead of data of each write, see cVFDDriver
+  unsigned int nMaxWrite;     ///< most data bytes of one write
+
+  /** bytes of writing columns [minX, maxX), a span wider than nMaxWrite is split into several writes */
+  unsigned int Cost(unsigned int minX, unsigned int maxX) const {
+    const unsigned int nStep = nMaxWrite / nSizeYb;
+    return (((maxX - minX + nStep - 1) / nStep) * nWriteHeader) + ((maxX - minX) * nSizeYb);
+  }
+  bool Mergeable(unsigned int minX, unsigned int maxX) const { return (maxX - minX) * nSizeYb <= nMaxWrite; }
+  static unsigned int Reports(unsigned int nBytes);
+public:
+  cVFDPlanner();
+
+  void clear(unsigned int sizeYb, unsigned int nHeader, unsigned int nMax);
+  /** mark column x as changed, columns are marked in ascending order, may be repeated */
+  void Dirty(unsigned int x);
+  /** mark columns [minX, maxX) as changed, like Dirty() of each column */
+  void Dirty(unsigned int minX, unsigned int maxX);
+  /** 
+   * Choose the cheapest writes for all changed columns. 
+   * \param nQueued  bytes, which are already queued ahead
+   * \return count of writes
+   */
+  unsigned int Plan(unsigned int nQueued);
+
+  unsigned int Spans() const { return nSpans; }
+  const cVFDSpan& Span(unsigned int i) const { return spans[i]; }
+  /** bytes of all planned writes */
+  unsigned int Bytes() const;
+};
+
+#endif
@@ -0,0 +1,321 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#include <time.h>
+#include <vdr/tools.h>
+
+#include "setup.h"
+#include "driver.h"
+#include "bitmap.h"
+#include "planner.h"
+#include "engine.h"
+#include "emulate.h"
+#include "mdm166a.h"
+#include "selftest.h"
+
+// Rounds of each case, the fastest one is reported
+static const int ROUNDS = 7;
+// Period of the render loop of cVFDWatch, budget of a frame in ms
+static const int FRAME_BUDGET = 100;
+
+/** monotonic time in nanoseconds */
+static double Now() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (t.tv_sec * 1e9) + t.tv_nsec;
+}
+
+/** repeatable pseudo random numbers, same data at each run */
+static unsigned int Random(unsigned int& nSeed) {
+  nSeed = (nSeed * 1103515245) + 12345;
+  return (nSeed >> 16) & 0x7fff;
+}
+
+void cVFDSelfTest::Report(const char* szLine) {
+  sReport = cString::sprintf("%s%s%s", *sReport ? *sReport : "", *sReport ? "\n" : "", szLine);
+}
+
+/**
+ * Measure each supported panel.
+ * \return one line per case, times in nanoseconds
+ */
+cString cVFDSelfTest::Benchmark() {
+  sReport = NULL;
+  for (int n = 0; n < eDriver_LASTITEM; ++n) {
+    cVFDDriver* pDriver = cVFDDriver::Create(n);
+    BenchEngine(pDriver->Width(), pDriver->Height());
+    BenchBitmap(pDriver->Width(), pDriver->Height());
+    delete pDriver;
+    BenchFlush(n, false);
+    BenchFlush(n, true);
+  }
+  return sReport;
+}
+
+/**
+ * Diff of a whole display, by the engine of cVFDEngine::Create() and
+ * by the runtime engine, with 2, 25 and 100 percent of bytes changed.
+ */
+void cVFDSelfTest::BenchEngine(unsigned int nWidth, unsigned int nHeight) {
+  static const unsigned int percent[] = { 2, 25, 100 };
+  const unsigned int nSizeYb = (nHeight + 7) / 8;
+  const unsigned int nBytes = nWidth * nSizeYb;
+  // about 10 ms for each round
+  const int nIter = max(100000 * 192 / (int) nBytes, 1);
+
+  unsigned char* fb = new unsigned char[nBytes];
+  unsigned char* bs = new unsigned char[nBytes];
+  cVFDEngine* engine[2] = { new cVFDEngineRuntime(nHeight), cVFDEngine::Create(nWidth, nHeight) };
+  cVFDPlanner planner;
+
+  for (unsigned int p = 0; p < sizeof(percent) / sizeof(*percent); ++p) {
+    unsigned int nSeed = 1;
+    for (unsigned int i = 0; i < nBytes; ++i) {
+      bs[i] = Random(nSeed);
+      fb[i] = (Random(nSeed) % 100) < percent[p] ? ~bs[i] : bs[i];
+    }
+    double best[2] = { 1e30, 1e30 };
+    for (int r = 0; r < ROUNDS; ++r) {
+      for (int e = 0; e < 2; ++e) {
+        double t = Now();
+        for (int k = 0; k < nIter; ++k) {
+          planner.clear(nSizeYb, 6, 255);
+          engine[e]->Diff(fb, bs, 0, nWidth, planner);
+        }
+        best[e] = min(best[e], (Now() - t) / nIter);
+      }
+    }
+    Report(cString::sprintf("engine %ux%u, %u%% changed: %s %.0f ns, %s %.0f ns",
+                            nWidth, nHeight, percent[p],
+                            engine[0]->Name(), best[0], engine[1]->Name(), best[1]));
+  }
+
+  delete engine[0];
+  delete engine[1];
+  delete[] fb;
+  delete[] bs;
+}
+
+/**
+ * Draw a typical frame into cVFDBitmap: rows of glyphs, a progress
+ * bar, some pixels, an inverted region and a scroll by one column.
+ */
+void cVFDSelfTest::BenchBitmap(unsigned int nWidth, unsigned int nHeight) {
+  const int w = nWidth;
+  const int h = nHeight;
+  const int nIter = max(20000 * 96 / w, 1);
+  cVFDBitmap bm(w, h);
+  uchar glyph[6 * 2];
+  for (unsigned int i = 0; i < sizeof(glyph); ++i)
+    glyph[i] = 0x5a ^ i;
+
+  double best = 1e30;
+  for (int r = 0; r < ROUNDS; ++r) {
+    double t = Now();
+    for (int k = 0; k < nIter; ++k) {
+      bm.clear();
+      for (int y = 1; y + 11 <= h; y += 12)
+        for (int x = 0; x + 6 <= w; x += 6)
+          bm.Blit(x, y, glyph, 6, 11);
+      bm.Rectangle(0, h - 4, w - 1, h - 1, false);
+      bm.FillRect(1, h - 3, k % w, h - 2);
+      for (int x = 0; x < w; x += 3)
+        bm.SetPixel(x, (x * 7) % h);
+      bm.Invert(w / 4, 0, w / 2, h / 2);
+      bm.Scroll(1);
+      bm.ClearDamage();
+    }
+    best = min(best, (Now() - t) / nIter);
+  }
+  Report(cString::sprintf("bitmap %ux%u: %.0f ns per frame", nWidth, nHeight, best));
+}
+
+/**
+ * Whole pipeline of a frame: draw, compose, diff, plan, build reports
+ * and decode them by an emulated display. The emulator only accounts
+ * its modelled bus time, by interrupt and by control transfers, which
+ * is compared with the frame budget.
+ * \param bWhole  every column changes, otherwise a growing bar like a progress
+ */
+void cVFDSelfTest::BenchFlush(int nDriver, bool bWhole) {
+  if (!OpenPanel(nDriver, eTransport_Emulate, 1)) {
+    close();
+    Report(cString::sprintf("flush panel %d: can't open emulated display", nDriver));
+    return;
+  }
+  cVFDTransportEmulate* e = dynamic_cast<cVFDTransportEmulate*>(Transport(0));
+  if (!e) {
+    close();
+    return;
+  }
+  e->Realtime(false);
+  const int w = Width();
+  const int h = Height();
+  const int nIter = max(2000 * 96 / w, 1);
+  const unsigned long nReports = e->Reports();
+  const unsigned long nInterrupt = e->BusTime(false);
+  const unsigned long nControl = e->BusTime(true);
+
+  double best = 1e30;
+  int nFrames = 0;
+  for (int r = 0; r < ROUNDS; ++r) {
+    double t = Now();
+    for (int k = 0; k < nIter; ++k, ++nFrames) {
+      clear();
+      Rectangle(0, 0, w - 1, h - 1, false);
+      if (bWhole) {
+        // stripes, which move by two columns at each frame
+        for (int x = 1 + ((nFrames & 1) * 2); x + 1 < w - 1; x += 4)
+          Rectangle(x, 1, x + 1, h - 2, true);
+      } else {
+        Rectangle(2, 2, 2 + (nFrames % (w - 4)), 5, true);
+      }
+      flush(false);
+    }
+    best = min(best, (Now() - t) / nIter);
+  }
+  Report(cString::sprintf("flush %dx%d, %s: %.1f us per frame, %.1f reports, "
+                          "bus %.1f ms interrupt, %.1f ms control of %d ms budget",
+                          w, h, bWhole ? "whole frame" : "progress bar", best / 1000,
+                          (double) (e->Reports() - nReports) / nFrames,
+                          (double) (e->BusTime(false) - nInterrupt) / nFrames / 1000,
+                          (double) (e->BusTime(true) - nControl) / nFrames / 1000, FRAME_BUDGET));
+  close();
+}
+
+/** set pixels of rectangle within RAM of a display, corners are inclusive */
+static void Paint(uchar* ram, unsigned int nSizeYb, int x1, int y1, int x2, int y2) {
+  for (int x = x1; x <= x2; ++x)
+    for (int y = y1; y <= y2; ++y)
+      ram[(x * nSizeYb) + (y / 8)] |= 0x80 >> (y % 8);
+}
+
+/**
+ * Run the regression check with each supported panel.
+ * \param bOk  false, if any panel differs from its expected state
+ * \return one line per panel, and one per failed step
+ */
+cString cVFDSelfTest::Test(bool& bOk) {
+  sReport = NULL;
+  bOk = true;
+  for (int n = 0; n < eDriver_LASTITEM; ++n) {
+    if (!TestPanel(n))
+      bOk = false;
+  }
+  return sReport;
+}
+
+/**
+ * Feed frames through cVFD into an emulated display. After each flush
+ * the decoded RAM, symbols and dimming level must match the state,
+ * which is painted here independently of cVFDBitmap.
+ */
+bool cVFDSelfTest::TestPanel(int nDriver) {
+  if (!OpenPanel(nDriver, eTransport_Emulate, 1)) {
+    close();
+    Report(cString::sprintf("test panel %d: can't open emulated display", nDriver));
+    return false;
+  }
+  const cVFDTransportEmulate* e = dynamic_cast<const cVFDTransportEmulate*>(Transport(0));
+  const int w = Width();
+  const int h = Height();
+  const unsigned int nSizeYb = (h + 7) / 8;
+  uchar* ram = new uchar[w * nSizeYb];
+  bool bOk = e != NULL;
+
+  // display is reset by open
+  memset(ram, 0x00, w * nSizeYb);
+  bOk = bOk && Expect(e, "reset", ram, 0, BRIGHT_FULL);
+
+  // whole screen: frame and a bar, symbols and dimming
+  clear();
+  Rectangle(0, 0, w - 1, h - 1, false);
+  Rectangle(w / 4, 2, w / 2, h - 3, true);
+  icons(eIconPLAY | eIconMUTE | eIconVOL3);
+  Brightness(BRIGHT_DIMM);
+  bOk = bOk && flush(false);
+  Paint(ram, nSizeYb, 0, 0, w - 1, 0);
+  Paint(ram, nSizeYb, 0, h - 1, w - 1, h - 1);
+  Paint(ram, nSizeYb, 0, 0, 0, h - 1);
+  Paint(ram, nSizeYb, w - 1, 0, w - 1, h - 1);
+  Paint(ram, nSizeYb, w / 4, 2, w / 2, h - 3);
+  bOk = bOk && Expect(e, "first frame", ram, eIconPLAY | eIconMUTE | eIconVOL3, BRIGHT_DIMM);
+
+  // partial update: bar is moved, only changed columns are written
+  clear();
+  Rectangle(0, 0, w - 1, h - 1, false);
+  Rectangle(w / 4 + 3, 2, w / 2 + 3, h - 3, true);
+  icons(eIconPAUSE | eIconMUTE);
+  Brightness(BRIGHT_FULL);
+  bOk = bOk && flush(false);
+  memset(ram, 0x00, w * nSizeYb);
+  Paint(ram, nSizeYb, 0, 0, w - 1, 0);
+  Paint(ram, nSizeYb, 0, h - 1, w - 1, h - 1);
+  Paint(ram, nSizeYb, 0, 0, 0, h - 1);
+  Paint(ram, nSizeYb, w - 1, 0, w - 1, h - 1);
+  Paint(ram, nSizeYb, w / 4 + 3, 2, w / 2 + 3, h - 3);
+  bOk = bOk && Expect(e, "partial frame", ram, eIconPAUSE | eIconMUTE, BRIGHT_FULL);
+
+  // redrawn with the same pixels, nothing is sent
+  unsigned long nReports = e ? e->Reports() : 0;
+  clear();
+  Rectangle(0, 0, w - 1, h - 1, false);
+  Rectangle(w / 4 + 3, 2, w / 2 + 3, h - 3, true);
+  bOk = bOk && flush(false);
+  if (bOk && e->Reports() != nReports) {
+    Report(cString::sprintf("test %dx%d: unchanged frame sent %lu reports", w, h, e->Reports() - nReports));
+    bOk = false;
+  }
+  if (bOk)
+    Report(cString::sprintf("test %dx%d: ok, %lu reports", w, h, e->Reports()));
+  else
+    Report(cString::sprintf("test %dx%d: failed", w, h));
+
+  delete[] ram;
+  close();
+  return bOk;
+}
+
+/**
+ * Compare the emulated display with the expected state.
+ * \param nIcons  expected symbols, by bit like cVFD::icons()
+ */
+bool cVFDSelfTest::Expect(const cVFDTransportEmulate* e, const char* szStep,
+                          const uchar* ram, unsigned int nIcons, int nDimm) {
+  for (unsigned int i = 0; i < e->RAMSize(); ++i) {
+    if (e->RAM()[i] != ram[i]) {
+      Report(cString::sprintf("test %dx%d: %s, RAM at %u is 0x%02x, expected 0x%02x",
+                              Width(), Height(), szStep, i, e->RAM()[i], ram[i]));
+      return false;
+    }
+  }
+  for (unsigned int i = 0; i < cVFDTransportEmulate::SYMBOLS; ++i) {
+    unsigned char c = (nIcons & (1 << i)) ? STATE_ON : STATE_OFF;
+    if (e->Symbol(i) != c) {
+      Report(cString::sprintf("test %dx%d: %s, symbol %u is %u, expected %u",
+                              Width(), Height(), szStep, i, e->Symbol(i), c));
+      return false;
+    }
+  }
+  if (e->Brightness() != nDimm) {
+    Report(cString::sprintf("test %dx%d: %s, dimming level is %d, expected %d",
+                            Width(), Height(), szStep, e->Brightness(), nDimm));
+    return false;
+  }
+  if (e->Errors()) {
+    Report(cString::sprintf("test %dx%d: %s, %lu invalid commands",
+                            Width(), Height(), szStep, e->Errors()));
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,45 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#ifndef __VFD_SELFTEST_H___
+#define __VFD_SELFTEST_H___
+
+#include <vdr/tools.h>
+#include "vfd.h"
+
+class cVFDTransportEmulate;
+
+/*
+ * Benchmark of the render path, run by SVDRP BENCH, and regression
+ * check, run by SVDRP TEST. Both work on private buffers and emulated
+ * displays for each supported panel, the driven displays are not touched.
+ * Each case of the benchmark reports the best of some rounds.
+ */
+class cVFDSelfTest : public cVFD {
+  cString sReport;
+
+  void Report(const char* szLine);
+  void BenchEngine(unsigned int nWidth, unsigned int nHeight);
+  void BenchBitmap(unsigned int nWidth, unsigned int nHeight);
+  void BenchFlush(int nDriver, bool bWhole);
+  bool TestPanel(int nDriver);
+  bool Expect(const cVFDTransportEmulate* e, const char* szStep,
+              const uchar* ram, unsigned int nIcons, int nDimm);
+public:
+  /** measure each panel, one line per case */
+  cString Benchmark();
+  /** feed frames through an emulated display of each panel, one line per panel */
+  cString Test(bool& bOk);
+};
+
+#endif
@@ -25,12 +25,11 @@
 
 #define DEFAULT_ON_EXIT      eOnExitMode_BLANKSCREEN  /**< Blank the device completely */
 #define DEFAULT_BRIGHTNESS   1
-#define DEFAULT_WIDTH        96
-#define DEFAULT_HEIGHT       16
 #define DEFAULT_FONT         "Sans:Bold"
 #define DEFAULT_TWO_LINE_MODE  eRenderMode_SingleLine
 #define DEFAULT_BIG_FONT_HEIGHT   14
 #define DEFAULT_SMALL_FONT_HEIGHT 7
+#define DEFAULT_GLYPH_CACHE  64   /**< KiB of glyph cache */
 #define DEFAULT_VOLUME_MODE   eVolumeMode_ShowEver    /**< Show the volume bar ever */
 #define DEFAULT_SUSPEND_MODE   eSuspendMode_Never      /**< Suspend display never */
 
@@ -39,14 +38,14 @@ cVFDSetup theSetup;
 
 /// Ctor, load default values
 cVFDSetup::cVFDSetup(void)
-:  m_cWidth(DEFAULT_WIDTH)
-,  m_cHeight(DEFAULT_HEIGHT)
 {
   m_nOnExit = DEFAULT_ON_EXIT;
+  m_nDriver = eDriver_MDM166A;
   m_nBrightness = DEFAULT_BRIGHTNESS;
   m_nRenderMode = DEFAULT_TWO_LINE_MODE;
   m_nBigFontHeight = DEFAULT_BIG_FONT_HEIGHT;
   m_nSmallFontHeight = DEFAULT_SMALL_FONT_HEIGHT;
+  m_nGlyphCache = DEFAULT_GLYPH_CACHE;
   m_nVolumeMode = DEFAULT_VOLUME_MODE;
   m_nSuspendMode = DEFAULT_SUSPEND_MODE;
   m_nSuspendTimeOn = 2200;
@@ -54,12 +53,21 @@ cVFDSetup::cVFDSetup(void)
   m_bSuspend_Timed = 1;   /**< Suspend display, resume short time */
   m_bSuspend_Icons = 1;   /**< Suspend icons */
 
+  m_nTransport = eTransport_USB;
+  m_bTransferAsync = 0;
+  m_bTransferControl = 0;
+  m_nEmulateLatency = 1000;
+  m_nFrameDeadline = 100;
+  m_nUnits = 1;
+  memset(m_szDevice, 0, sizeof(m_szDevice));
+  memset(m_szCacheDir, 0, sizeof(m_szCacheDir));
+  m_bSpanUnits = 0;
+
   strncpy(m_szFont,DEFAULT_FONT,sizeof(m_szFont));
+  memset(m_szFallbackFont, 0, sizeof(m_szFallbackFont));
 }
 
 cVFDSetup::cVFDSetup(const cVFDSetup& x)
-:  m_cWidth(DEFAULT_WIDTH)
-,  m_cHeight(DEFAULT_HEIGHT)
 {
   *this = x;
 }
@@ -67,11 +75,13 @@ cVFDSetup::cVFDSetup(const cVFDSetup& x)
 cVFDSetup& cVFDSetup::operator = (const cVFDSetup& x)
 {
   m_nOnExit = x.m_nOnExit;
+  m_nDriver = x.m_nDriver;
   m_nBrightness = x.m_nBrightness;
 
   m_nRenderMode = x.m_nRenderMode;
   m_nBigFontHeight = x.m_nBigFontHeight;
   m_nSmallFontHeight = x.m_nSmallFontHeight;
+  m_nGlyphCache = x.m_nGlyphCache;
 
   m_nVolumeMode = x.m_nVolumeMode;
   m_nSuspendMode = x.m_nSuspendMode;
@@ -81,7 +91,18 @@ cVFDSetup& cVFDSetup::operator = (const cVFDSetup& x)
   m_bSuspend_Timed = x.m_bSuspend_Timed;
   m_bSuspend_Icons = x.m_bSuspend_Icons;
 
+  m_nTransport = x.m_nTransport;
+  m_bTransferAsync = x.m_bTransferAsync;
+  m_bTransferControl = x.m_bTransferControl;
+  m_nEmulateLatency = x.m_nEmulateLatency;
+  m_nFrameDeadline = x.m_nFrameDeadline;
+  m_nUnits = x.m_nUnits;
+  memcpy(m_szDevice, x.m_szDevice, sizeof(m_szDevice));
+  strncpy(m_szCacheDir, x.m_szCacheDir, sizeof(m_szCacheDir));
+  m_bSpanUnits = x.m_bSpanUnits;
+
   strncpy(m_szFont,x.m_szFont,sizeof(m_szFont));
+  strncpy(m_szFallbackFont,x.m_szFallbackFont,sizeof(m_szFallbackFont));
 
   return *this;
 }
@@ -128,8 +149,16 @@ bool cVFDSetup::SetupParse(const char *szName, const char *szValue)
     return true;
   }
 
+  // Fonts for missing characters
+  if(!strcasecmp(szName, "FallbackFont")) {
+    strn0cpy(m_szFallbackFont, szValue ? szValue : "", sizeof(m_szFallbackFont));
+    dsyslog("targaVFD: %s set to %s", szName, m_szFallbackFont);
+    return true;
+  }
+
   if(SetupParseInt(szName, szValue, "BigFont", 5, 24, DEFAULT_BIG_FONT_HEIGHT, m_nBigFontHeight)) { return true; }
   if(SetupParseInt(szName, szValue, "SmallFont", 5, 24, DEFAULT_SMALL_FONT_HEIGHT, m_nSmallFontHeight)) { return true; }
+  if(SetupParseInt(szName, szValue, "GlyphCache", 0, 4096, DEFAULT_GLYPH_CACHE, m_nGlyphCache)) { return true; }
   if(SetupParseInt(szName, szValue, "TwoLineMode", eRenderMode_SingleLine, eRenderMode_LASTITEM, DEFAULT_TWO_LINE_MODE, m_nRenderMode)) { return true; }
   if(SetupParseInt(szName, szValue, "VolumeMode", eVolumeMode_ShowNever, eVolumeMode_LASTITEM, DEFAULT_VOLUME_MODE, m_nVolumeMode)) { return true; }
   if(SetupParseInt(szName, szValue, "SuspendMode", eSuspendMode_Never, eSuspendMode_LASTITEM, DEFAULT_SUSPEND_MODE, m_nSuspendMode)) { return true; }
@@ -151,8 +180,10 @@ void cVFDMenuSetup::Store(void)
   SetupStore("OnExit",     theSetup.m_nOnExit);
   SetupStore("Brightness", theSetup.m_nBrightness);
   SetupStore("Font",       theSetup.m_szFont);
+  SetupStore("FallbackFont", theSetup.m_szFallbackFont);
   SetupStore("BigFont", theSetup.m_nBigFontHeight);
   SetupStore("SmallFont", theSetup.m_nSmallFontHeight);
+  SetupStore("GlyphCache", theSetup.m_nGlyphCache);
   SetupStore("TwoLineMode",theSetup.m_nRenderMode);
   SetupStore("VolumeMode", theSetup.m_nVolumeMode);
   SetupStore("SuspendMode", theSetup.m_nSuspendMode);
@@ -16,6 +16,7 @@
 
 #include <vdr/menuitems.h>
 #define memberof(x) (sizeof(x)/sizeof(*x))
+#define MAX_UNITS 4   /**< Displays, which can be driven by one plugin instance */
 
 enum eOnExitMode {
    eOnExitMode_SHOWMSG     /**< Do nothing - just leave the "last" message there */
@@ -48,18 +49,33 @@ enum eSuspendMode {
   ,eSuspendMode_LASTITEM
 };
 
+enum eTransport {
+   eTransport_USB       /**< Display attached by libusb */
+  ,eTransport_Emulate   /**< Emulated display, without hardware */
+  ,eTransport_Hidraw    /**< Display attached by hidraw, fallback to libusb */
+  ,eTransport_LASTITEM
+};
+
+enum eDriver {
+   eDriver_MDM166A      /**< Futaba MDM166A, 96x16 */
+  ,eDriver_128x64       /**< command set of MDM166A, 128x64 */
+  ,eDriver_256x64       /**< command set of MDM166A, 256x64 */
+  ,eDriver_LASTITEM
+};
+
 struct cVFDSetup 
 {
   int          m_nOnExit;
   int          m_nBrightness;
 
-  const int    m_cWidth;
-  const int    m_cHeight;
+  int          m_nDriver;     /**< panel, see eDriver */
 
   int          m_nBigFontHeight;
   int          m_nSmallFontHeight;
 
   char         m_szFont[256];
+  char         m_szFallbackFont[256];  /**< fonts for missing characters, separated by comma */
+  int          m_nGlyphCache;          /**< cap of glyph cache in KiB, 0 for unlimited */
 
   int          m_nRenderMode; /** enable two line mode */
 
@@ -72,6 +88,16 @@ struct cVFDSetup
   int          m_bSuspend_Timed;   /**< Suspend display, resume short time */
   int          m_bSuspend_Icons;   /**< Suspend icons */
 
+  int          m_nTransport;       /**< Used transport backend (command line) */
+  int          m_bTransferAsync;   /**< Submit reports pipelined, without waiting (command line) */
+  int          m_bTransferControl; /**< Use control transfers, even if an interrupt OUT endpoint exists (command line) */
+  int          m_nEmulateLatency;  /**< Modelled duration of a report transfer in us, for emulation (command line) */
+  int          m_nFrameDeadline;   /**< Deadline of a frame transfer in ms, watchdog escalates if missed (command line) */
+  int          m_nUnits;           /**< Count of driven displays (command line) */
+  char         m_szDevice[MAX_UNITS][32]; /**< Bus/port or serial number of each display, empty for any (command line) */
+  char         m_szCacheDir[256];  /**< Directory of glyph cache files, empty to disable (plugin start) */
+  int          m_bSpanUnits;       /**< Displays side by side form one canvas, otherwise they are mirrored (command line) */
+
   cVFDSetup(void);
   cVFDSetup(const cVFDSetup& x);
   cVFDSetup& operator = (const cVFDSetup& x);
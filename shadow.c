@@ -0,0 +1,78 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#include <string.h>
+
+#include "shadow.h"
+
+cVFDShadow::cVFDShadow() {
+  ram = NULL;
+  stale = NULL;
+  nWidth = 0;
+  nSizeYb = 0;
+  Reset(-1);  // unknown dimming level, until reset is sent
+}
+
+cVFDShadow::~cVFDShadow() {
+  Destroy();
+}
+
+bool cVFDShadow::Create(unsigned int width, unsigned int sizeYb) {
+  Destroy();
+  ram = new unsigned char[width * sizeYb];
+  stale = new unsigned char[width];
+  if(!ram || !stale)
+    return false;
+  nWidth = width;
+  nSizeYb = sizeYb;
+  Reset(-1);  // unknown dimming level, until reset is sent
+  return true;
+}
+
+void cVFDShadow::Destroy() {
+  if(ram) {
+    delete[] ram;
+    ram = NULL;
+  }
+  if(stale) {
+    delete[] stale;
+    stale = NULL;
+  }
+  nWidth = 0;
+  nSizeYb = 0;
+}
+
+void cVFDShadow::Invalidate() {
+  if(stale)
+    memset(stale, 0x01, nWidth);
+  bStale = true;
+}
+
+void cVFDShadow::Validate() {
+  if(stale)
+    memset(stale, 0x00, nWidth);
+  bStale = false;
+}
+
+/**
+ * The display clears its RAM and all symbols, turns the 
+ * clock off and returns to the dimming level of reset.
+ */
+void cVFDShadow::Reset(int nDimmReset) {
+  if(ram)
+    memset(ram, 0x00, nWidth * nSizeYb);
+  Invalidate();
+  nSymbols = 0;
+  nDimm = nDimmReset;
+  nClock = -1;
+}
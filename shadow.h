@@ -0,0 +1,57 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#ifndef __VFD_SHADOW_H___
+#define __VFD_SHADOW_H___
+
+/*
+ * Model of the state of one display, like it was sent to it :
+ * graphics RAM, symbols, dimming level and shown clock.
+ * Commands, which wouldn't change this state, are dropped.
+ */
+class cVFDShadow {
+  unsigned char* ram;      ///< RAM, column by column : x * sizeYb + yb
+  unsigned char* stale;    ///< flag of each column, which may differ from canvas
+  bool bStale;
+  unsigned int nWidth;
+  unsigned int nSizeYb;
+  unsigned int nSymbols;   ///< bit mask of enabled symbols
+  int nDimm;               ///< dimming level
+  int nClock;              ///< shown clock, or -1
+public:
+  cVFDShadow();
+  virtual ~cVFDShadow();
+
+  bool Create(unsigned int width, unsigned int sizeYb);
+  void Destroy();
+  /** state after reset of display */
+  void Reset(int nDimmReset);
+
+  unsigned char* RAM() const { return ram; }
+
+  /** mark column x, it may differ from canvas */
+  void Invalidate(unsigned int x) { stale[x] = 1; bStale = true; }
+  void Invalidate();
+  bool Stale() const { return bStale; }
+  bool Stale(unsigned int x) const { return stale[x] != 0; }
+  /** all columns are equal to canvas */
+  void Validate();
+  unsigned int Symbols() const { return nSymbols; }
+  void Symbols(unsigned int n) { nSymbols = n; }
+  int Dimm() const { return nDimm; }
+  void Dimm(int n) { nDimm = n; }
+  int Clock() const { return nClock; }
+  void Clock(int n) { nClock = n; }
+};
+
+#endif
@@ -59,6 +59,7 @@ bool cVFDWatch::RenderSpectrumAnalyzer()
         int saEndY = this->Height();
   
         this->clear(); 
+        this->SelectLayer(eLayerSpectrum);
 
         for ( i=0; i < bands; i++ ) {
           // draw bar
@@ -17,9 +17,11 @@
 
 #include "targavfd.h"
 #include "vfd.h"
+#include "ffont.h"
 #include "watch.h"
 #include "status.h"
 #include "setup.h"
+#include "selftest.h"
 
 static const char *VERSION        = "0.3.2";
 
@@ -55,17 +57,115 @@ const char* cPluginTargaVFD::Description(void) {
 const char *cPluginTargaVFD::CommandLineHelp(void)
 {
   // Return a string that describes all known command line options.
-  return "";
+  return "  -a,       --async        submit reports pipelined, without waiting\n"
+         "                           for each USB transfer\n"
+         "  -c,       --control      send reports as control transfer, even if\n"
+         "                           the display has an interrupt OUT endpoint,\n"
+         "                           also modelled by emulate, see SVDRP BENCH\n"
+         "  -t TYPE,  --transport=TYPE  transport to display, usb (default),\n"
+         "                           hidraw (fall back to usb) or emulate\n"
+         "  -p PANEL, --panel=PANEL  geometry of display, mdm166a (default),\n"
+         "                           128x64 or 256x64 with the commands of\n"
+         "                           the MDM166A, e.g. for emulate\n"
+         "  -l US,    --latency=US   modelled duration of a report transfer\n"
+         "                           in microseconds, for emulate (default 1000)\n"
+         "  -w MS,    --watchdog=MS  deadline of a frame transfer in milliseconds,\n"
+         "                           cancel, reset or reopen a wedged display\n"
+         "                           if missed (default 100)\n"
+         "  -d DEV,   --device=DEV   drive display at bus/port (like 3-1.2) or\n"
+         "                           with serial number, 'any' for the first\n"
+         "                           free one. Repeat to drive more displays\n"
+         "  -s,       --span         displays side by side form one canvas,\n"
+         "                           otherwise all show the same\n";
 }
 
 bool cPluginTargaVFD::ProcessArgs(int argc, char *argv[])
 {
+  // Implement command line argument processing here if applicable.
+  static struct option long_options[] = {
+    { "async",    no_argument,       NULL, 'a' },
+    { "control",  no_argument,       NULL, 'c' },
+    { "transport", required_argument, NULL, 't' },
+    { "panel",    required_argument, NULL, 'p' },
+    { "latency",  required_argument, NULL, 'l' },
+    { "watchdog", required_argument, NULL, 'w' },
+    { "device",   required_argument, NULL, 'd' },
+    { "span",     no_argument,       NULL, 's' },
+    { NULL,       0,                 NULL, 0 }
+  };
+
+  int c;
+  int nDevices = 0;
+  while ((c = getopt_long(argc, argv, "act:p:l:w:d:s", long_options, NULL)) != -1) {
+    switch (c) {
+      case 'a':
+        theSetup.m_bTransferAsync = 1;
+        break;
+      case 'c':
+        theSetup.m_bTransferControl = 1;
+        break;
+      case 't':
+        if(!strcasecmp(optarg, "usb")) {
+          theSetup.m_nTransport = eTransport_USB;
+        } else if(!strcasecmp(optarg, "emulate")) {
+          theSetup.m_nTransport = eTransport_Emulate;
+        } else if(!strcasecmp(optarg, "hidraw")) {
+          theSetup.m_nTransport = eTransport_Hidraw;
+        } else {
+          esyslog("targaVFD: unknown transport '%s'", optarg);
+          return false;
+        }
+        break;
+      case 'p':
+        if(!strcasecmp(optarg, "mdm166a")) {
+          theSetup.m_nDriver = eDriver_MDM166A;
+        } else if(!strcasecmp(optarg, "128x64")) {
+          theSetup.m_nDriver = eDriver_128x64;
+        } else if(!strcasecmp(optarg, "256x64")) {
+          theSetup.m_nDriver = eDriver_256x64;
+        } else {
+          esyslog("targaVFD: unknown panel '%s'", optarg);
+          return false;
+        }
+        break;
+      case 'l':
+        theSetup.m_nEmulateLatency = max(0, atoi(optarg));
+        break;
+      case 'w':
+        theSetup.m_nFrameDeadline = max(10, atoi(optarg));
+        break;
+      case 'd':
+        if(nDevices >= MAX_UNITS) {
+          esyslog("targaVFD: too many displays, up to %d supported", MAX_UNITS);
+          return false;
+        }
+        strn0cpy(theSetup.m_szDevice[nDevices], 
+                 strcasecmp(optarg, "any") ? optarg : "",
+                 sizeof(theSetup.m_szDevice[nDevices]));
+        theSetup.m_nUnits = ++nDevices;
+        break;
+      case 's':
+        theSetup.m_bSpanUnits = 1;
+        break;
+      default:
+        return false;
+    }
+  }
   return true;
 }
 
 bool cPluginTargaVFD::Initialize(void)
 {
   // Initialize any background activities the plugin shall perform.
+
+  // rendered glyphs are kept over restarts
+#if APIVERSNUM >= 10730
+  const char* szCacheDir = CacheDirectory(PLUGIN_NAME_I18N);
+#else
+  const char* szCacheDir = ConfigDirectory(PLUGIN_NAME_I18N);
+#endif
+  if(szCacheDir)
+    strn0cpy(theSetup.m_szCacheDir, szCacheDir, sizeof(theSetup.m_szCacheDir));
   return true;
 }
 
@@ -271,11 +371,83 @@ const char* cPluginTargaVFD::SVDRPCommandIcon(const char *Option, int &ReplyCode
   return "wrong parameter";
 }
 
+cString cPluginTargaVFD::SVDRPCommandStat(const char *Option, int &ReplyCode)
+{
+  // watch thread replaces units, engine and font
+  cMutexLock lock(&m_dev.Mutex());
+  if(m_bSuspend || !m_dev.Units()) {
+      ReplyCode=251; 
+      return "driver suspended";
+  }
+  cString s;
+  for(unsigned int i = 0; i < m_dev.Units(); ++i) {
+    cVFDTransportStat t;
+    const char* szDevice = NULL;
+    if(!m_dev.Statistic(i, t, &szDevice))
+      break;
+    s = cString::sprintf("%s%sdisplay %u (%s): frames %lu, reports %lu, deadline missed %lu "
+                         "(cancel %lu, clear halt %lu, reset %lu, reopen %lu)",
+                         *s ? *s : "", i ? "\n" : "", i, szDevice,
+                         t.nFrames, t.nReports, t.nDeadlineMissed,
+                         t.nCancel, t.nClearHalt, t.nReset, t.nReopen);
+  }
+  const cVFDOptimizerStat& o = m_dev.OptimizerStatistic();
+  s = cString::sprintf("%s\noptimizer: frames %lu, saved %lu bytes, %lu reports (last frame %u bytes, %u reports)",
+                       *s, o.nFrames, o.nBytesSaved, o.nReportsSaved,
+                       o.nLastBytesSaved, o.nLastReportsSaved);
+  const cVFDEngine* e = m_dev.Engine();
+  if(e)
+    s = cString::sprintf("%s\nengine: %s, compared %lu bytes, copied %lu bytes",
+                         *s, e->Name(), e->Compared(), e->Copied());
+  cVFDGlyphCacheStat g;
+  if(m_dev.GlyphCacheStatistic(g))
+    s = cString::sprintf("%s\nglyph cache: %u glyphs, %lu bytes (limit %lu, used %lu, kerning %lu), "
+                         "hits %lu, misses %lu, mapped %lu, evictions %lu",
+                         *s, g.nGlyphs, g.nReserved, g.nLimit, g.nResident, g.nKerning,
+                         g.nHits, g.nMisses, g.nMapped, g.nEvictions);
+  ReplyCode=250; 
+  return s;
+}
+
+cString cPluginTargaVFD::SVDRPCommandBench(const char *Option, int &ReplyCode)
+{
+  // private buffers, the driven displays keep running
+  cVFDSelfTest t;
+  ReplyCode=250; 
+  return t.Benchmark();
+}
+
+cString cPluginTargaVFD::SVDRPCommandTest(const char *Option, int &ReplyCode)
+{
+  // private buffers and emulated displays, the driven displays keep running
+  cVFDSelfTest t;
+  bool bOk;
+  cString s = t.Test(bOk);
+  ReplyCode = bOk ? 250 : 550; 
+  return s;
+}
+
 cString cPluginTargaVFD::SVDRPCommand(const char *Command, const char *Option, int &ReplyCode)
 {
   ReplyCode=501; 
   const char* szReplay = "unknown command";
 
+  if(!strcasecmp(Command, "STAT")) {
+    cString s = SVDRPCommandStat(Option,ReplyCode);
+    dsyslog("targaVFD:  SVDRP %s - %d (%s)", Command, ReplyCode, *s);
+    return s;
+  }
+  if(!strcasecmp(Command, "BENCH")) {
+    cString s = SVDRPCommandBench(Option,ReplyCode);
+    dsyslog("targaVFD:  SVDRP %s - %d", Command, ReplyCode);
+    return s;
+  }
+  if(!strcasecmp(Command, "TEST")) {
+    cString s = SVDRPCommandTest(Option,ReplyCode);
+    dsyslog("targaVFD:  SVDRP %s - %d (%s)", Command, ReplyCode, *s);
+    return s;
+  }
+
   if(!strcasecmp(Command, "ON")) {
     szReplay = SVDRPCommandOn(Option,ReplyCode);
   } else if(!strcasecmp(Command, "OFF")) {
@@ -321,6 +493,12 @@ const char **cPluginTargaVFD::SVDRPHelpPages(void)
     "    Suspend driver of display.\n",
     "ICON [name] [on|off|auto]\n"
     "    Force state of icon.\n",
+    "STAT\n"
+    "    Show transfer statistic of display.\n",
+    "BENCH\n"
+    "    Measure the render path of each panel, displays are not touched.\n",
+    "TEST\n"
+    "    Check frames through an emulated display of each panel.\n",
     NULL
     };
   if(m_szIconHelpPage)
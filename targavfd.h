@@ -33,6 +33,9 @@ protected:
   const char* SVDRPCommandOn(const char *Option, int &ReplyCode);
   const char* SVDRPCommandOff(const char *Option, int &ReplyCode);
   const char* SVDRPCommandIcon(const char *Option, int &ReplyCode);
+  cString SVDRPCommandStat(const char *Option, int &ReplyCode);
+  cString SVDRPCommandBench(const char *Option, int &ReplyCode);
+  cString SVDRPCommandTest(const char *Option, int &ReplyCode);
 
 public:
   cPluginTargaVFD(void);
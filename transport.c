@@ -0,0 +1,77 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#include <vdr/tools.h>
+
+#include "setup.h"
+#include "transport.h"
+#include "driver.h"
+#include "usb.h"
+#include "emulate.h"
+#include "hidraw.h"
+
+/**
+ * Both report builders hold a complete frame of the panel, so a full
+ * redraw is sent without a flush amid the frame.
+ */
+cVFDTransport::cVFDTransport(const cVFDDriver* pDriver) {
+  for(unsigned int i = 0; i < 2; ++i) {
+    if(!packets[i].Create(pDriver->FrameBytes()))
+      esyslog("targaVFD: unable to allocate reports");
+  }
+  nPacket = 0;
+  packet = &packets[nPacket];
+  nReportsLast = 0;
+  nFrameQueued = 0;
+  nFrameDone = 0;
+  memset(&stat, 0, sizeof(stat));
+  bResync = false;
+}
+
+/**
+ * Account a frame, which was handed to the bus.
+ */
+void cVFDTransport::FrameQueued(unsigned int nReports) {
+  nReportsLast = nReports;
+  ++nFrameQueued;
+  ++stat.nFrames;
+  stat.nReports += nReports;
+}
+
+/**
+ * Continue with the other report builder.
+ */
+void cVFDTransport::SwapPacket() {
+  nPacket ^= 1;
+  packet = &packets[nPacket];
+}
+
+/**
+ * Create the transport backend.
+ *
+ * \param nTransport  selected backend, see eTransport
+ * \param szDevice    bus/port or serial number of display, NULL for any
+ * \param pDriver     geometry and commands of panel
+ */
+cVFDTransport* cVFDTransport::Create(int nTransport, const char* szDevice, const cVFDDriver* pDriver) {
+  switch(nTransport) {
+    case eTransport_Emulate:
+      return new cVFDTransportEmulate(pDriver, theSetup.m_nEmulateLatency, theSetup.m_bTransferControl);
+    case eTransport_Hidraw:
+      return new cVFDTransportHidraw(pDriver, szDevice, theSetup.m_nFrameDeadline);
+    default:
+    case eTransport_USB:
+      return new cVFDTransportUSB(pDriver, szDevice, theSetup.m_bTransferAsync, !theSetup.m_bTransferControl,
+                                   theSetup.m_nFrameDeadline);
+  }
+}
@@ -0,0 +1,93 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#ifndef __VFD_TRANSPORT_H___
+#define __VFD_TRANSPORT_H___
+
+#include "packet.h"
+
+class cVFDDriver;
+
+/*
+ * Counters of a transport, incl. the escalation steps of the watchdog
+ */
+struct cVFDTransportStat {
+  unsigned long nFrames;          ///< flushed frames
+  unsigned long nReports;         ///< sent reports
+  unsigned long nDeadlineMissed;  ///< frames, which missed their deadline
+  unsigned long nCancel;          ///< escalation: pending transfers cancelled
+  unsigned long nClearHalt;       ///< escalation: endpoint halt cleared
+  unsigned long nReset;           ///< escalation: device reset
+  unsigned long nReopen;          ///< escalation: device reopened
+};
+
+/*
+ * Interface of the transport, which moves the HID reports
+ * of a frame to the display.
+ */
+class cVFDTransport {
+protected:
+  /* double buffered report builder, a backend may fill one while the other is in transfer */
+  cVFDPacket packets[2];
+  unsigned int nPacket;
+  cVFDPacket* packet;
+  unsigned int nReportsLast;
+
+  unsigned int nFrameQueued;
+  volatile unsigned int nFrameDone;
+
+  cVFDTransportStat stat;
+  bool bResync;
+
+  void FrameQueued(unsigned int nReports);
+  void FrameDone(unsigned int nFrame) { nFrameDone = nFrame; }
+  void SwapPacket();
+public:
+  cVFDTransport(const cVFDDriver* pDriver);
+  virtual ~cVFDTransport() {}
+
+  virtual const char* Name() const = 0;
+  virtual bool open() = 0;
+  virtual void close() = 0;
+  virtual bool isopen() const = 0;
+  /** true, if Flush() may block its caller, the display is then served by its own thread */
+  virtual bool Blocking() const { return false; }
+
+  /** builder for the reports of the next frame */
+  cVFDPacket* Packet() const { return packet; }
+  /** 
+   * Transfer all reports of the current builder. On failure the 
+   * transport closes itself and the reports are dropped.
+   */
+  virtual bool Flush() = 0;
+
+  /** true once, if the display may be out of sync, e.g. a frame was dropped */
+  bool ResyncNeeded() { bool b = bResync; bResync = false; return b; }
+  const cVFDTransportStat& Statistic() const { return stat; }
+
+  /** true, if the device reappeared since it was lost */
+  virtual bool DeviceArrived() const { return false; }
+  /** reopen the device, after it was lost */
+  virtual bool Reconnect() { close(); return open(); }
+
+  /** true, while reports of a previous frame are still on the bus */
+  bool FramePending() const { return nFrameDone != nFrameQueued; }
+  /** last frame, which was completely transferred to the display */
+  unsigned int FrameCompleted() const { return nFrameDone; }
+  /** count of reports, which was produced by last flush */
+  unsigned int ReportsLastFrame() const { return nReportsLast; }
+
+  static cVFDTransport* Create(int nTransport, const char* szDevice, const cVFDDriver* pDriver);
+};
+
+#endif
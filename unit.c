@@ -0,0 +1,152 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#include <vdr/tools.h>
+
+#include "setup.h"
+#include "unit.h"
+
+// Backoff of polling for a lost display
+static const int RECONNECT_MIN_MS = 500;
+static const int RECONNECT_MAX_MS = 30000;
+
+cVFDUnit::cVFDUnit(int nTransport, const char* szDevice, const cVFDDriver* pDriver)
+: cThread("targaVFD: transport thread")
+, nTransport(nTransport)
+, pDriver(pDriver)
+, sDevice(szDevice)
+{
+  transport = cVFDTransport::Create(nTransport, szDevice, pDriver);
+  nReconnectDelay = RECONNECT_MIN_MS;
+  bFlush = 0;
+  memset(&stat, 0, sizeof(stat));
+}
+
+cVFDUnit::~cVFDUnit() {
+  close();
+  delete transport;
+}
+
+/**
+ * Open the display.
+ * \param bThreaded  transfer frames by own thread, always done for a blocking transport
+ */
+bool cVFDUnit::open(bool bThreaded)
+{
+  close();
+  bool bOpen = transport->open();
+  if(!bOpen && nTransport == eTransport_Hidraw) {
+    // libusb stay as fallback
+    isyslog("targaVFD: hidraw not usable, fall back to libusb");
+    delete transport;
+    transport = cVFDTransport::Create(eTransport_USB, *sDevice, pDriver);
+    bOpen = transport->open();
+  }
+  if(bOpen)
+    dsyslog("targaVFD: using transport '%s' for display %s", transport->Name(), Device());
+  Account();
+  nReconnectDelay = RECONNECT_MIN_MS;
+  if(bThreaded || transport->Blocking()) {
+    SetDescription("targaVFD: transport thread of display %s", Device());
+    Start();
+  }
+  return bOpen;
+}
+
+void cVFDUnit::close() {
+  if(Active()) {
+    // last frame, e.g. to blank the display, is still delivered
+    if(Handed())
+      Wait();
+    Cancel(3);
+  }
+  Hand(false);
+  transport->close();
+}
+
+/**
+ * Reopen a lost display, if it has reappeared or the backoff time elapsed.
+ */
+bool cVFDUnit::Reconnect() {
+  if(!tsReconnect.TimedOut() && !transport->DeviceArrived())
+    return false;
+
+  if(Handed())
+    Wait();
+  if(!transport->Reconnect()) {
+    nReconnectDelay = min(nReconnectDelay * 2, RECONNECT_MAX_MS);
+    tsReconnect.Set(nReconnectDelay);
+    dsyslog("targaVFD: display %s still lost, retry in %d ms", Device(), nReconnectDelay);
+    return false;
+  }
+  isyslog("targaVFD: display %s reconnected", Device());
+  nReconnectDelay = RECONNECT_MIN_MS;
+  return true;
+}
+
+/**
+ * Transfer all reports of the current builder. If the unit has
+ * its own thread, the frame is only handed over.
+ */
+bool cVFDUnit::Flush() {
+  if(!Active()) {
+    bool bOk = transport->Flush();
+    Account();
+    return bOk;
+  }
+
+  Wait();
+  cMutexLock lock(&mutex);
+  if(!transport->Packet()->empty()) {
+    Hand(true);
+    cond.Broadcast();
+  }
+  return true;
+}
+
+/**
+ * Wait until the thread has handed the previous frame to the bus.
+ */
+void cVFDUnit::Wait() {
+  cMutexLock lock(&mutex);
+  while(Handed() && Active())
+    cond.TimedWait(mutex, 100);
+  Hand(false);
+}
+
+/**
+ * Copy the counters of transport, they are written by the flushing thread.
+ */
+void cVFDUnit::Account() {
+  cMutexLock lock(&mutex);
+  stat = transport->Statistic();
+}
+
+void cVFDUnit::Action(void) {
+  mutex.Lock();
+  while(Running()) {
+    if(!Handed()) {
+      cond.TimedWait(mutex, 100);
+      continue;
+    }
+    // builder is owned by this thread, the render thread isn't blocked meanwhile
+    mutex.Unlock();
+    // a failed transfer closes the transport, it's reconnected by render thread
+    transport->Flush();
+    mutex.Lock();
+    stat = transport->Statistic();
+    Hand(false);
+    cond.Broadcast();
+  }
+  mutex.Unlock();
+}
@@ -0,0 +1,76 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#ifndef __VFD_UNIT_H___
+#define __VFD_UNIT_H___
+
+#include <vdr/thread.h>
+#include <vdr/tools.h>
+#include "transport.h"
+#include "driver.h"
+
+/*
+ * One attached display with its own transport thread. A frame is built
+ * by the render thread and handed over to this thread for transfer,
+ * so a slow display can't stall the others.
+ */
+class cVFDUnit : protected cThread {
+  cVFDTransport* transport;
+  int nTransport;
+  const cVFDDriver* pDriver;  ///< geometry and commands of panel
+  cString sDevice;   ///< bus/port or serial number, empty for any
+
+  cTimeMs tsReconnect;
+  int nReconnectDelay;
+
+  mutable cMutex mutex;
+  cCondVar cond;
+  volatile int bFlush;   ///< frame is handed over, builder is owned by thread, see Handed()
+  cVFDTransportStat stat;  ///< copy of counters of transport, taken after each flush
+
+  /** true, while the thread owns the builder, it's read without mutex by render thread */
+  bool Handed() const { return __sync_add_and_fetch(const_cast<volatile int*>(&bFlush), 0) != 0; }
+  void Hand(bool b) { if(b) __sync_fetch_and_or(&bFlush, 1); else __sync_fetch_and_and(&bFlush, 0); }
+  void Account();
+  void Wait();
+protected:
+  virtual void Action(void);
+public:
+  cVFDUnit(int nTransport, const char* szDevice, const cVFDDriver* pDriver);
+  virtual ~cVFDUnit();
+
+  bool open(bool bThreaded);
+  void close();
+  bool isopen() const { return transport->isopen(); }
+  bool Reconnect();
+
+  /** selected display, or "any" */
+  const char* Device() const { return isempty(*sDevice) ? "any" : *sDevice; }
+  const char* Name() const { return transport->Name(); }
+  /** backend of display, e.g. to inspect an emulated display */
+  cVFDTransport* Transport() const { return transport; }
+
+  /** builder for the reports of the next frame, waits until previous frame is handed to the bus */
+  cVFDPacket* Packet() { if(Handed()) Wait(); return transport->Packet(); }
+  bool Flush();
+
+  /** true, while the thread or the bus is busy with a previous frame */
+  bool Busy() const { return Handed() || transport->FramePending(); }
+  bool ResyncNeeded() { if(Handed()) Wait(); return transport->ResyncNeeded(); }
+  /** counters of transport, as of the last flush */
+  void Statistic(cVFDTransportStat& s) const { cMutexLock lock(&mutex); s = stat; }
+  unsigned int FrameCompleted() const { return transport->FrameCompleted(); }
+  unsigned int ReportsLastFrame() const { return transport->ReportsLastFrame(); }
+};
+
+#endif
@@ -0,0 +1,724 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#include <vdr/tools.h>
+
+#include "usb.h"
+#include "mdm166a.h"
+
+// Values for transaction's data packet.
+static const int CONTROL_REQUEST_TYPE_OUT = LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_CLASS | LIBUSB_RECIPIENT_INTERFACE;
+
+// From the HID spec:
+static const int HID_SET_REPORT = 0x09;
+static const int HID_REPORT_TYPE_OUTPUT = 0x02;
+
+
+static const int INTERFACE_NUMBER = 0;
+
+// Steps of watchdog, if frames miss their deadline in a row
+enum eEscalate {
+  eEscalateCancel = 1,  ///< cancel pending transfers
+  eEscalateClearHalt,   ///< clear halt of interrupt endpoint
+  eEscalateReset,       ///< reset the device
+  eEscalateReopen       ///< give up the device and reopen it
+};
+
+// The setup packet of a control transfer is written in front of the report
+typedef char HeadroomCheck[(cVFDPacket::HEADROOM >= LIBUSB_CONTROL_SETUP_SIZE) ? 1 : -1];
+
+// Time to wait for completion of cancelled transfers, before they are left to libusb
+static const int DRAIN_TIMEOUT_MS = 5000;
+
+// Guards the owner of transfers, which were left to libusb
+static cMutex mutexOrphan;
+
+
+/*
+ * Thread to dispatch the completion of asynchronous transfers
+ */
+class cVFDEventThread : public cThread {
+  libusb_context* ctx;
+protected:
+  virtual void Action(void) {
+    while(Running()) {
+      struct timeval tv = { 0, 100000 };
+      libusb_handle_events_timeout_completed(ctx, &tv, NULL);
+    }
+  }
+public:
+  cVFDEventThread(libusb_context* c)
+  : cThread("targaVFD: usb event thread")
+  , ctx(c) {}
+  virtual ~cVFDEventThread() { Cancel(3); }
+};
+
+/*
+ * One slot of the transfer pipeline, the buffer is owned
+ * by the report builder
+ */
+struct cVFDTransfer {
+  cVFDTransportUSB* pTransport;
+  struct libusb_transfer* xfer;
+  unsigned int nPacket;
+  unsigned int nFrame;
+  bool bLast;  ///< last report of a frame
+  bool bBusy;
+
+  static void LIBUSB_CALL Callback(struct libusb_transfer *xfer) {
+    cVFDTransfer* t = (cVFDTransfer*) xfer->user_data;
+    cMutexLock lock(&mutexOrphan);
+    if(t->pTransport) // NULL, if the transfer was left to libusb
+      t->pTransport->TransferDone(t, xfer->status);
+  }
+};
+
+cVFDTransportUSB::cVFDTransportUSB(const cVFDDriver* pDriver, const char* szDevice, bool bPipelined, bool bUseInterrupt, int nDeadlineMs)
+: cVFDTransport(pDriver)
+, sDevice(szDevice) {
+	ctx = NULL;
+	devh = NULL;
+    bInit = false;
+  bHotplug = false;
+  bArrived = false;
+  bInterrupt = bUseInterrupt;
+  epOut = 0;
+  bAsync = bPipelined;
+  pEvents = NULL;
+  transfers = NULL;
+  nTransfers = 0;
+  nInflight[0] = nInflight[1] = 0;
+  bTransferError = false;
+  nDeadline = max(nDeadlineMs, 10);
+  bTimedOut = false;
+  nMissed = 0;
+  bOrphaned = false;
+}
+
+cVFDTransportUSB::~cVFDTransportUSB() {
+  cVFDTransportUSB::close();
+}
+
+bool cVFDTransportUSB::open()
+{
+	int result;
+	bool ready = false;
+
+  dsyslog("targaVFD: scanning for Futaba MDM166A...");
+  bInit = true;
+  //Initialize libusb
+	result = libusb_init(&ctx);
+	if (result >= 0)
+	{
+		devh = OpenDevice();
+		if (devh != NULL)
+		{
+			ready = true;
+			epOut = bInterrupt ? FindInterruptOut() : 0;
+			dsyslog("targaVFD: reports are sent by %s", epOut ? "interrupt transfer" : "control transfer");
+		}
+		else
+		{
+			esyslog("targaVFD: Unable to find the device%s%s!", isempty(*sDevice) ? "" : " ", isempty(*sDevice) ? "" : *sDevice);
+		}
+	}
+	else
+	{
+		esyslog("targaVFD: Unable to initialize libusb! %s (%d)",usberror(result),result);
+	}
+  if(ready && bAsync) {
+    ready = AllocTransfers();
+  }
+  ResetMissed();
+  if(!ready) {
+    if(devh) {
+		  libusb_release_interface(devh, 0);
+		  libusb_close(devh);
+    }
+    devh = NULL;
+  }
+
+  packet->clear();
+  return ready;
+}
+
+/**
+ * Enumerate all attached displays and claim the first one, which matches 
+ * the selected bus/port or serial number and isn't used by another unit.
+ * \return handle of claimed device, NULL if none found.
+ */
+libusb_device_handle* cVFDTransportUSB::OpenDevice() {
+
+  libusb_device** list = NULL;
+  libusb_device_handle* h = NULL;
+
+  ssize_t n = libusb_get_device_list(ctx, &list);
+  if(n < 0) {
+    esyslog("targaVFD: libusb_get_device_list failed! %s (%d)",usberror(n),(int)n);
+    return NULL;
+  }
+  for(ssize_t i = 0; i < n && !h; ++i) {
+    struct libusb_device_descriptor desc;
+    if(libusb_get_device_descriptor(list[i], &desc) < 0
+       || desc.idVendor != VENDOR_ID || desc.idProduct != PRODUCT_ID)
+      continue;
+
+    char szPath[32];
+    DevicePath(list[i], szPath, sizeof(szPath));
+    int result = libusb_open(list[i], &h);
+    if(result < 0) {
+      esyslog("targaVFD: libusb_open %s failed! %s (%d)",szPath,usberror(result),result);
+      h = NULL;
+      continue;
+    }
+    unsigned char szSerial[64] = "";
+    if(desc.iSerialNumber)
+      libusb_get_string_descriptor_ascii(h, desc.iSerialNumber, szSerial, sizeof(szSerial));
+    dsyslog("targaVFD: found display at %s, serial '%s'", szPath, szSerial);
+
+    if(!isempty(*sDevice) && strcmp(*sDevice, szPath) && strcmp(*sDevice, (const char*) szSerial)) {
+      libusb_close(h);
+      h = NULL;
+      continue;
+    }
+    // Detach the hidusb driver from the HID to enable using libusb.
+    libusb_detach_kernel_driver(h, INTERFACE_NUMBER);
+    result = libusb_claim_interface(h, INTERFACE_NUMBER);
+    if(result < 0) {
+      // busy, if the display is driven by another unit
+      dsyslog("targaVFD: libusb_claim_interface %s failed! %s (%d)",szPath,usberror(result),result);
+      libusb_close(h);
+      h = NULL;
+    }
+  }
+  libusb_free_device_list(list, 1);
+  return h;
+}
+
+/**
+ * Path of device like sysfs names it, bus and ports e.g. "3-1.2"
+ */
+void cVFDTransportUSB::DevicePath(libusb_device* dev, char* szPath, size_t nSize) {
+
+  uint8_t ports[7];
+  int n = libusb_get_port_numbers(dev, ports, sizeof(ports));
+  int l = snprintf(szPath, nSize, "%d", libusb_get_bus_number(dev));
+  for(int i = 0; i < n && l > 0 && (size_t) l < nSize; ++i)
+    l += snprintf(szPath + l, nSize - l, "%c%d", i ? '.' : '-', ports[i]);
+}
+
+/**
+ * Inspect configuration descriptor for an interrupt OUT endpoint.
+ * \return address of endpoint, 0 if none found.
+ */
+unsigned char cVFDTransportUSB::FindInterruptOut() const {
+
+  struct libusb_config_descriptor* config = NULL;
+  unsigned char ep = 0;
+
+  int result = libusb_get_active_config_descriptor(libusb_get_device(devh), &config);
+  if(result < 0 || !config) {
+    esyslog("targaVFD: libusb_get_active_config_descriptor failed! %s (%d)",usberror(result),result);
+    return 0;
+  }
+  for(int i = 0; i < config->bNumInterfaces && !ep; ++i) {
+    const struct libusb_interface* itf = &config->interface[i];
+    for(int a = 0; a < itf->num_altsetting && !ep; ++a) {
+      const struct libusb_interface_descriptor* alt = &itf->altsetting[a];
+      if(alt->bInterfaceNumber != INTERFACE_NUMBER || alt->bAlternateSetting != 0)
+        continue;
+      for(int e = 0; e < alt->bNumEndpoints; ++e) {
+        const struct libusb_endpoint_descriptor* d = &alt->endpoint[e];
+        if((d->bEndpointAddress & LIBUSB_ENDPOINT_DIR_MASK) == LIBUSB_ENDPOINT_OUT
+           && (d->bmAttributes & LIBUSB_TRANSFER_TYPE_MASK) == LIBUSB_TRANSFER_TYPE_INTERRUPT) {
+          ep = d->bEndpointAddress;
+          break;
+        }
+      }
+    }
+  }
+  libusb_free_config_descriptor(config);
+  return ep;
+}
+
+void cVFDTransportUSB::close() {
+
+  if(bHotplug) {
+    libusb_hotplug_deregister_callback(ctx, hHotplug);
+    bHotplug = false;
+  }
+  Release();
+  if(pEvents) {
+    delete pEvents;
+    pEvents = NULL;
+  }
+  if(bInit) {
+      // Deinitialize libusb, unless transfers were left to it
+      if(!bOrphaned)
+        libusb_exit(ctx);
+      ctx = NULL;
+      bInit = false;
+  }
+  bOrphaned = false;
+}
+
+/**
+ * Release the device, but keep libusb initialized.
+ */
+void cVFDTransportUSB::Release() {
+
+  FreeTransfers();
+  if (devh != NULL && bOrphaned) {
+      // pending transfers still refer the handle
+      devh = NULL;
+  }
+  if (devh != NULL) {
+      int result = libusb_release_interface(devh, 0);
+			if (result < 0)
+			{
+  			esyslog("targaVFD: libusb_release_interface failed! %s (%d)",usberror(result),result);
+			}
+      libusb_close(devh);
+      devh = NULL;
+  }
+}
+
+/**
+ * The device was lost by a failed transfer. Release it and watch for
+ * arrival of the display, if libusb supports hotplug.
+ */
+void cVFDTransportUSB::Lost() {
+
+  Release();
+  if(!bHotplug && ctx && libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG)) {
+    bArrived = false;
+    int result = libusb_hotplug_register_callback(ctx,
+                   LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED, LIBUSB_HOTPLUG_NO_FLAGS,
+                   VENDOR_ID, PRODUCT_ID, LIBUSB_HOTPLUG_MATCH_ANY,
+                   HotplugCallback, this, &hHotplug);
+    if(result == LIBUSB_SUCCESS) {
+      bHotplug = true;
+      // dispatch of hotplug events
+      pEvents = new cVFDEventThread(ctx);
+      pEvents->Start();
+    } else {
+      esyslog("targaVFD: libusb_hotplug_register_callback failed! %s (%d)",usberror(result),result);
+    }
+  }
+}
+
+int LIBUSB_CALL cVFDTransportUSB::HotplugCallback(libusb_context *ctx, libusb_device *device, libusb_hotplug_event event, void *user_data) {
+  cVFDTransportUSB* pTransport = (cVFDTransportUSB*) user_data;
+  dsyslog("targaVFD: Futaba MDM166A arrived");
+  pTransport->bArrived = true;
+  return 0; // stay registered until reconnect
+}
+
+/**
+ * Allocate the transfer pipeline and start dispatching of completions.
+ */
+bool cVFDTransportUSB::AllocTransfers() {
+
+  // each report of both packet builders owns one transfer
+  nTransfers = 2 * packet->Capacity();
+  transfers = new cVFDTransfer[nTransfers];
+  for(unsigned int i = 0; i < nTransfers; ++i) {
+    transfers[i].pTransport = this;
+    transfers[i].nPacket = i / packet->Capacity();
+    transfers[i].bBusy = false;
+    transfers[i].xfer = libusb_alloc_transfer(0);
+    if(!transfers[i].xfer) {
+      esyslog("targaVFD: libusb_alloc_transfer failed!");
+      FreeTransfers();
+      return false;
+    }
+  }
+  nInflight[0] = nInflight[1] = 0;
+  bTransferError = false;
+  bTimedOut = false;
+  FrameDone(nFrameQueued);
+
+  pEvents = new cVFDEventThread(ctx);
+  pEvents->Start();
+  return true;
+}
+
+/**
+ * Cancel pending transfers, wait for their completion and release the pipeline.
+ * Transfers, which never complete, are left to libusb together with the event
+ * thread, the context and the device handle. Freeing them would let a late
+ * completion write into freed memory.
+ */
+void cVFDTransportUSB::FreeTransfers() {
+
+  if(!transfers)
+    return;
+
+  cTimeMs tsDrain;
+  while(!CancelTransfers()) {
+    if(tsDrain.Elapsed() >= (uint64_t) DRAIN_TIMEOUT_MS) {
+      esyslog("targaVFD: %u transfers not completed on close, left to libusb", nInflight[0] + nInflight[1]);
+      cMutexLock lock(&mutexOrphan);
+      for(unsigned int i = 0; i < nTransfers; ++i)
+        transfers[i].pTransport = NULL;
+      transfers = NULL;   // leaked on purpose
+      pEvents = NULL;     // keeps dispatching events of the context
+      bOrphaned = true;
+      FrameDone(nFrameQueued);
+      return;
+    }
+  }
+
+  if(pEvents) {
+    delete pEvents;
+    pEvents = NULL;
+  }
+  for(unsigned int i = 0; i < nTransfers; ++i) {
+    if(transfers[i].xfer && !transfers[i].bBusy)
+      libusb_free_transfer(transfers[i].xfer);
+  }
+  delete[] transfers;
+  transfers = NULL;
+  FrameDone(nFrameQueued);
+}
+
+/**
+ * Cancel pending transfers and wait for their completion.
+ * \retval false   transfers not completed in time.
+ */
+bool cVFDTransportUSB::CancelTransfers() {
+
+  if(!transfers)
+    return true;
+
+  cMutexLock lock(&mutexTransfer);
+  for(unsigned int i = 0; i < nTransfers; ++i) {
+    if(transfers[i].bBusy)
+      libusb_cancel_transfer(transfers[i].xfer);
+  }
+  while((nInflight[0] || nInflight[1]) && pEvents) {
+    if(!condTransfer.TimedWait(mutexTransfer, nDeadline))
+      return false;
+  }
+  return true;
+}
+
+/**
+ * A frame missed its deadline, the display is probably wedged. 
+ * Each further frame in a row, which misses its deadline, takes
+ * the next step : cancel, clear halt, reset and reopen.
+ */
+void cVFDTransportUSB::Escalate() {
+
+  ++stat.nDeadlineMissed;
+  bResync = true; // the frame was dropped
+
+  int nStep;
+  {
+    // nMissed is reset by completions on the event thread
+    cMutexLock lock(&mutexTransfer);
+    nStep = min(++nMissed, (unsigned int)eEscalateReopen);
+    if(nStep == eEscalateCancel && !(transfers && (nInflight[0] || nInflight[1])))
+      nStep = eEscalateClearHalt; // nothing to cancel, e.g. synchronous transfers
+    if(nStep == eEscalateClearHalt && !epOut)
+      nStep = eEscalateReset; // control endpoint can't be halted
+    nMissed = nStep;
+  }
+
+  int result = LIBUSB_SUCCESS;
+  switch(nStep) {
+    case eEscalateCancel:
+      isyslog("targaVFD: frame missed deadline of %d ms, cancel transfers", nDeadline);
+      ++stat.nCancel;
+      CancelTransfers();
+      break;
+    case eEscalateClearHalt:
+      isyslog("targaVFD: frame missed deadline of %d ms, clear halt of endpoint", nDeadline);
+      ++stat.nClearHalt;
+      CancelTransfers();
+      result = libusb_clear_halt(devh, epOut);
+      break;
+    case eEscalateReset:
+      isyslog("targaVFD: frame missed deadline of %d ms, reset device", nDeadline);
+      ++stat.nReset;
+      CancelTransfers();
+      result = libusb_reset_device(devh);
+      break;
+    default:
+      result = LIBUSB_ERROR_TIMEOUT;
+      break;
+  }
+  if(result < 0) {
+    // last resort, let reconnect reopen the device
+    esyslog("targaVFD: display still wedged, reopen device : %s (%d)",usberror(result),result);
+    ++stat.nReopen;
+    ResetMissed();
+    Lost();
+  }
+}
+
+/**
+ * Wait until all reports of a packet builder are transferred.
+ * \retval false   transfers not completed in time.
+ */
+bool cVFDTransportUSB::WaitPacket(unsigned int n) {
+
+  cMutexLock lock(&mutexTransfer);
+  while(nInflight[n]) {
+    // transfers time out by itself at deadline
+    if(!condTransfer.TimedWait(mutexTransfer, 2 * nDeadline))
+      return false;
+  }
+  return true;
+}
+
+/**
+ * True once, if an asynchronous transfer has timed out since the last call.
+ */
+bool cVFDTransportUSB::TakeTimedOut() {
+
+  cMutexLock lock(&mutexTransfer);
+  bool b = bTimedOut;
+  bTimedOut = false;
+  return b;
+}
+
+/**
+ * A frame was transferred in time, the watchdog starts again with its first step.
+ */
+void cVFDTransportUSB::ResetMissed() {
+
+  cMutexLock lock(&mutexTransfer);
+  nMissed = 0;
+}
+
+/**
+ * True, if an asynchronous transfer has failed.
+ */
+bool cVFDTransportUSB::TransferFailed() {
+
+  cMutexLock lock(&mutexTransfer);
+  return bTransferError;
+}
+
+/**
+ * Completion of an asynchronous transfer, called from event thread.
+ */
+void cVFDTransportUSB::TransferDone(cVFDTransfer* t, int status) {
+
+  cMutexLock lock(&mutexTransfer);
+  if(status == LIBUSB_TRANSFER_TIMED_OUT) {
+    bTimedOut = true;
+  } else if (status != LIBUSB_TRANSFER_COMPLETED
+          && status != LIBUSB_TRANSFER_CANCELLED) {
+    esyslog("targaVFD: asynchronous transfer failed : status %d", status);
+    bTransferError = true;
+  }
+  // frame is done, even if it failed - the watchdog takes care
+  if(t->bLast) {
+    if(status == LIBUSB_TRANSFER_COMPLETED && !bTimedOut)
+      nMissed = 0;
+    FrameDone(t->nFrame);
+  }
+  t->bBusy = false;
+  --nInflight[t->nPacket];
+  condTransfer.Broadcast();
+}
+
+bool cVFDTransportUSB::Flush() {
+
+  if(packet->empty())
+    return true;
+  if(!isopen()) {
+    packet->clear();
+    return false;
+  }
+  return transfers ? FlushAsync() : FlushSync();
+}
+
+bool cVFDTransportUSB::FlushSync() {
+
+	int bytes;
+  cTimeMs tsFrame;
+
+  for(unsigned int i = 0; i < packet->Reports(); ++i) {
+    // all reports of a frame share the deadline, 0 would mean unlimited
+    int timeout = max(nDeadline - (int)tsFrame.Elapsed(), 1);
+    if(epOut) {
+      int transferred = 0;
+      bytes = libusb_interrupt_transfer(
+			  devh,
+			  epOut,
+			  packet->Report(i),
+			  packet->ReportLength(i),
+			  &transferred,
+			  timeout);
+      if(bytes == LIBUSB_SUCCESS)
+        bytes = transferred;
+    } else {
+	  bytes = libusb_control_transfer(
+			  devh,
+			  CONTROL_REQUEST_TYPE_OUT ,
+			  HID_SET_REPORT,
+			  (HID_REPORT_TYPE_OUTPUT<<8)|0x00,
+			  INTERFACE_NUMBER,
+			  packet->Report(i),
+			  packet->ReportLength(i),
+			  timeout);
+    }
+
+	  if (bytes == LIBUSB_ERROR_TIMEOUT)
+	  {
+      packet->clear();
+      Escalate();
+      return false;
+	  }
+	  if (bytes <= 0)
+	  {
+      esyslog("targaVFD: libusb_%s_transfer failed : %s (%d)",epOut ? "interrupt" : "control",usberror(bytes),bytes);
+      packet->clear();
+      Lost();
+      return false;
+	  }
+  }
+  FrameQueued(packet->Reports());
+  FrameDone(nFrameQueued);
+  packet->clear();
+  ResetMissed();
+  return true;
+}
+
+/**
+ * Submit all reports of the current builder without waiting for their
+ * completion, the reports are transferred directly from the builder.
+ * Meanwhile the next frame is built in the other builder, the caller 
+ * is only blocked if this is still in transfer.
+ */
+bool cVFDTransportUSB::FlushAsync() {
+
+  const unsigned int nFrame = nFrameQueued + 1;
+  const unsigned int nReports = packet->Reports();
+  int result = LIBUSB_SUCCESS;
+  cTimeMs tsFrame;
+
+  if(TakeTimedOut()) {
+    // previous frame missed its deadline
+    packet->clear();
+    Escalate();
+    return false;
+  }
+
+  for(unsigned int i = 0; i < nReports && !TransferFailed(); ++i) {
+    cVFDTransfer* t = &transfers[(nPacket * packet->Capacity()) + i];
+    unsigned char* slot = packet->Slot(i);
+
+    // all reports of a frame share the deadline, 0 would mean unlimited
+    unsigned int timeout = max(nDeadline - (int)tsFrame.Elapsed(), 1);
+    t->nFrame = nFrame;
+    t->bLast = (i + 1 == nReports);
+    if(epOut) {
+      libusb_fill_interrupt_transfer(t->xfer, devh, epOut,
+          packet->Report(i), packet->ReportLength(i),
+          cVFDTransfer::Callback, t, timeout);
+    } else {
+      libusb_fill_control_setup(slot,
+          CONTROL_REQUEST_TYPE_OUT,
+          HID_SET_REPORT,
+          (HID_REPORT_TYPE_OUTPUT<<8)|0x00,
+          INTERFACE_NUMBER,
+          packet->ReportLength(i));
+      libusb_fill_control_transfer(t->xfer, devh, slot,
+          cVFDTransfer::Callback, t, timeout);
+    }
+
+    mutexTransfer.Lock();
+    t->bBusy = true;
+    ++nInflight[nPacket];
+    mutexTransfer.Unlock();
+
+    result = libusb_submit_transfer(t->xfer);
+    if(result < 0) {
+      TransferDone(t, LIBUSB_TRANSFER_CANCELLED);
+      break;
+    }
+  }
+  FrameQueued(nReports);
+
+  // continue with the other builder, once it's transferred
+  SwapPacket();
+  bool bWedged = result >= 0 && !TransferFailed() && !WaitPacket(nPacket);
+  packet->clear();
+
+  if(result < 0 || TransferFailed()) {
+    if(result < 0)
+      esyslog("targaVFD: libusb_submit_transfer failed : %s (%d)",usberror(result),result);
+    Lost();
+    return false;
+  }
+  if(bWedged) {
+    // previous frame is still in transfer, its timeout is handled now
+    TakeTimedOut();
+    Escalate();
+    return false;
+  }
+  return true;
+}
+
+const char *cVFDTransportUSB::usberror(int ret) const
+{
+  switch(ret) {
+    case LIBUSB_SUCCESS:
+      return "Success (no error).";
+
+    case LIBUSB_ERROR_IO:
+      return "Input/output error.";
+
+    case LIBUSB_ERROR_INVALID_PARAM: 	
+      return "Invalid parameter.";
+
+    case LIBUSB_ERROR_ACCESS:
+      return "Access denied (insufficient permissions).";
+
+    case LIBUSB_ERROR_NO_DEVICE:
+      return "No such device (it may have been disconnected).";
+
+    case LIBUSB_ERROR_NOT_FOUND:
+      return "Entity not found.";
+
+    case LIBUSB_ERROR_BUSY:
+      return "Resource busy.";
+
+    case LIBUSB_ERROR_TIMEOUT:
+      return "Operation timed out.";
+
+    case LIBUSB_ERROR_OVERFLOW:
+      return "Overflow.";
+
+    case LIBUSB_ERROR_PIPE: 	
+      return "Pipe error.";
+
+    case LIBUSB_ERROR_INTERRUPTED:
+      return "System call interrupted (perhaps due to signal).";
+
+    case LIBUSB_ERROR_NO_MEM:
+      return "Insufficient memory.";
+
+    case LIBUSB_ERROR_NOT_SUPPORTED:
+      return "Operation not supported or unimplemented on this platform.";
+
+    case LIBUSB_ERROR_OTHER:
+      return "Other error. ";
+    }
+    return "unknown error";
+}
+
@@ -0,0 +1,90 @@
+/*
+ * targavfd plugin for VDR (C++)
+ *
+ * (C) 2010-2011 Andreas Brachold <vdr07 AT deltab de>
+ *
+ * This targavfd plugin is free software: you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, version 3 of the License.
+ *
+ * See the files README and COPYING for details.
+ *
+ */
+
+#ifndef __VFD_USB_H___
+#define __VFD_USB_H___
+
+#include <libusb-1.0/libusb.h>
+#include <vdr/thread.h>
+#include <vdr/tools.h>
+#include "transport.h"
+
+class cVFDEventThread;
+struct cVFDTransfer;
+
+/*
+ * Transport by libusb, reports are streamed through the interrupt OUT
+ * endpoint, if the device exposes one, otherwise sent as HID_SET_REPORT
+ */
+class cVFDTransportUSB : public cVFDTransport {
+  friend struct cVFDTransfer;
+  libusb_context* ctx;
+  struct libusb_device_handle* devh;
+  cString sDevice;        ///< selected bus/port or serial number, empty for any
+    bool bInit;
+  bool bInterrupt;
+
+  /* watch for arrival, after the device was lost */
+  bool bHotplug;
+  libusb_hotplug_callback_handle hHotplug;
+  volatile bool bArrived;
+  unsigned char epOut;    ///< interrupt OUT endpoint, or 0 for control transfers
+
+  /* pipelined submission, see FlushAsync() */
+  bool bAsync;
+  cVFDEventThread* pEvents;
+  cVFDTransfer* transfers;
+  unsigned int nTransfers; ///< count of reports, which can be submitted without waiting for completion
+  cMutex mutexTransfer;
+  cCondVar condTransfer;
+  unsigned int nInflight[2];
+  volatile bool bTransferError;
+
+  /* watchdog, see Escalate() */
+  int nDeadline;          ///< deadline of a frame, in ms
+  volatile bool bTimedOut;
+  unsigned int nMissed;   ///< frames in a row, which missed their deadline, guarded by mutexTransfer
+
+  bool bOrphaned;         ///< transfers didn't complete and were left to libusb
+public:
+  cVFDTransportUSB(const cVFDDriver* pDriver, const char* szDevice, bool bPipelined, bool bUseInterrupt, int nDeadlineMs);
+  virtual ~cVFDTransportUSB();
+
+  virtual const char* Name() const { return "usb"; }
+  virtual bool open();
+  virtual void close();
+  virtual bool isopen() const { return devh != NULL; }
+  virtual bool Flush();
+  virtual bool DeviceArrived() const { return bArrived; }
+private:
+  void Release();
+  void Lost();
+  static int LIBUSB_CALL HotplugCallback(libusb_context *ctx, libusb_device *device, libusb_hotplug_event event, void *user_data);
+  libusb_device_handle* OpenDevice();
+  static void DevicePath(libusb_device* dev, char* szPath, size_t nSize);
+  unsigned char FindInterruptOut() const;
+  bool FlushSync();
+  bool FlushAsync();
+  bool AllocTransfers();
+  void FreeTransfers();
+  bool CancelTransfers();
+  void Escalate();
+  bool WaitPacket(unsigned int n);
+  bool TakeTimedOut();
+  bool TransferFailed();
+  void ResetMissed();
+  void TransferDone(cVFDTransfer* t, int status);
+  const char *usberror(int ret) const;
+};
+
+#endif
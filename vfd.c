@@ -23,253 +23,181 @@
 #include "ffont.h"
 #include "vfd.h"
 
-// Values for transaction's data packet.
-static const int CONTROL_REQUEST_TYPE_OUT = LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_CLASS | LIBUSB_RECIPIENT_INTERFACE;
-
-// From the HID spec:
-static const int HID_SET_REPORT = 0x09;
-static const int HID_REPORT_TYPE_OUTPUT = 0x02;
-
-static const int unsigned MAX_CONTROL_OUT_TRANSFER_SIZE = 63;
-
-static const int INTERFACE_NUMBER = 0;
-static const int TIMEOUT_MS = 5000;
-
-// Defines from display datasheet
-static const int VENDOR_ID = 0x019c2;
-static const int PRODUCT_ID = 0x06a11;
-
-static const unsigned char ICON_PLAY       = 0x00; //Play
-static const unsigned char ICON_PAUSE      = 0x01; //Pause
-static const unsigned char ICON_RECORD     = 0x02; //Record
-static const unsigned char ICON_MESSAGE    = 0x03; //Message symbol (without the inner @)
-static const unsigned char ICON_MSGAT      = 0x04; //Message @
-static const unsigned char ICON_MUTE       = 0x05; //Mute
-static const unsigned char ICON_WLAN1      = 0x06; //WLAN (tower base)
-static const unsigned char ICON_WLAN2      = 0x07; //WLAN strength (1 of 3)
-static const unsigned char ICON_WLAN3      = 0x08; //WLAN strength (2 of 3)
-static const unsigned char ICON_WLAN4      = 0x09; //WLAN strength (3 of 3)
-static const unsigned char ICON_VOLUME     = 0x0A; //Volume (the word)
-static const unsigned char ICON_VOL1       = 0x0B; //Volume level 1 of 14
-static const unsigned char ICON_VOL2       = 0x0C; //Volume level 2 of 14
-static const unsigned char ICON_VOL3       = 0x0D; //Volume level 3 of 14
-static const unsigned char ICON_VOL4       = 0x0E; //Volume level 4 of 14
-static const unsigned char ICON_VOL5       = 0x0F; //Volume level 5 of 14
-static const unsigned char ICON_VOL6       = 0x10; //Volume level 6 of 14
-static const unsigned char ICON_VOL7       = 0x11; //Volume level 7 of 14
-static const unsigned char ICON_VOL8       = 0x12; //Volume level 8 of 14
-static const unsigned char ICON_VOL9       = 0x13; //Volume level 9 of 14
-static const unsigned char ICON_VOL10      = 0x14; //Volume level 10 of 14
-static const unsigned char ICON_VOL11      = 0x15; //Volume level 11 of 14
-static const unsigned char ICON_VOL12      = 0x16; //Volume level 12 of 14
-static const unsigned char ICON_VOL13      = 0x17; //Volume level 13 of 14
-static const unsigned char ICON_VOL14      = 0x18; //Volume level 14 of 14
-
-static const unsigned char STATE_OFF       = 0x00; //Symbol off
-static const unsigned char STATE_ON        = 0x01; //Symbol on
-static const unsigned char STATE_ONHIGH    = 0x02; //Symbol on, high intensity, can only be used with the volume symbols
-
-static const unsigned char CMD_PREFIX      = 0x1b;
-static const unsigned char CMD_SETCLOCK    = 0x00; //Actualize the time of the display
-static const unsigned char CMD_SMALLCLOCK  = 0x01; //Display small clock on display
-static const unsigned char CMD_BIGCLOCK    = 0x02; //Display big clock on display
-static const unsigned char CMD_SETSYMBOL   = 0x30; //Enable or disable symbol
-static const unsigned char CMD_SETDIMM     = 0x40; //Set the dimming level of the display
-static const unsigned char CMD_RESET       = 0x50; //Reset all configuration data to default and clear
-static const unsigned char CMD_SETRAM      = 0x60; //Set the actual graphics RAM offset for next data write
-static const unsigned char CMD_SETPIXEL    = 0x70; //Write pixel data to RAM of the display
-static const unsigned char CMD_TEST1       = 0xf0; //Show vertical test pattern
-static const unsigned char CMD_TEST2       = 0xf1; //Show horizontal test pattern
-
-static const unsigned char TIME_12         = 0x00; //12 hours format
-static const unsigned char TIME_24         = 0x01; //24 hours format
-
-static const unsigned char BRIGHT_OFF      = 0x00; //Display off
-static const unsigned char BRIGHT_DIMM     = 0x01; //Display dimmed
-static const unsigned char BRIGHT_FULL     = 0x02; //Display full brightness
-
 cVFDQueue::cVFDQueue() {
-	devh = NULL;
-    bInit = false;
+  nUnits = 0;
+  nSelected = ALL_UNITS;
+  for(unsigned int i = 0; i < MAX_UNITS; ++i)
+    bResync[i] = false;
 }
 
 cVFDQueue::~cVFDQueue() {
   cVFDQueue::close();
 }
 
-bool cVFDQueue::open()
-{
-	int result;
-	bool ready = false;
-
-  dsyslog("targaVFD: scanning for Futaba MDM166A...");
-  bInit = true;
-  //Initialize libusb
-	result = libusb_init(NULL);
-	if (result >= 0)
-	{
-		devh = libusb_open_device_with_vid_pid(NULL, VENDOR_ID, PRODUCT_ID);
-		if (devh != NULL)
-		{
-			// a targavfd has been detected.
-			// Detach the hidusb driver from the HID to enable using libusb.
-			libusb_detach_kernel_driver(devh, INTERFACE_NUMBER);
-			{
-				result = libusb_claim_interface(devh, INTERFACE_NUMBER);
-				if (result >= 0)
-				{
-					ready = true;
-				}
-				else
-				{
-    			esyslog("targaVFD: libusb_claim_interface error! %s (%d)",usberror(result),result);
-				}
-			}
-		}
-		else
-		{
-			esyslog("targaVFD: Unable to find the device!");
-		}
-	}
-	else
-	{
-		esyslog("targaVFD: Unable to initialize libusb! %s (%d)",usberror(result),result);
-	}
-  if(!ready) {
-    if(devh)  
-		  libusb_release_interface(devh, 0);
-    devh = NULL;
-  }
+/**
+ * Open all configured displays, each with its own transport thread
+ * if there more than one. Displays, which are not present yet, are 
+ * opened later like a lost display.
+ * \param pDriver     geometry and commands of panel, must outlive the displays
+ * \param nTransport  backend of each display, see eTransport
+ * \param nDisplays   count of displays, selected by the configured devices
+ */
+bool cVFDQueue::open(const cVFDDriver* pDriver, int nTransport, int nDisplays)
+{
+  cVFDQueue::close();
 
-  while (!empty()) {
-    pop();
+  bool bOpen = false;
+  bool bThreaded = nDisplays > 1;
+  for(int i = 0; i < nDisplays && i < MAX_UNITS; ++i) {
+    const char* szDevice = theSetup.m_szDevice[i];
+    units[nUnits] = new cVFDUnit(nTransport, isempty(szDevice) ? NULL : szDevice, pDriver);
+    if(units[nUnits]->open(bThreaded)) {
+      bOpen = true;
+    } else if(bThreaded) {
+      esyslog("targaVFD: display %s not present, retry later", units[nUnits]->Device());
+    }
+    ++nUnits;
   }
-
-  return ready;
+  nSelected = ALL_UNITS;
+  if(!bOpen)
+    cVFDQueue::close();
+  return bOpen;
 }
 
 void cVFDQueue::close() {
+  for(unsigned int i = 0; i < nUnits; ++i) {
+    delete units[i];
+    units[i] = NULL;
+    bResync[i] = false;
+  }
+  nUnits = 0;
+}
 
-  if (devh != NULL) {
-      int result = libusb_release_interface(devh, 0);
-			if (result < 0)
-			{
-  			esyslog("targaVFD: libusb_release_interface failed! %s (%d)",usberror(result),result);
-			}
-      libusb_close(devh);
-      devh = NULL;
+bool cVFDQueue::isopen() const {
+  for(unsigned int i = 0; i < nUnits; ++i) {
+    if(!units[i]->isopen())
+      return false;
   }
-  if(bInit) {
-      // Deinitialize libusb 
-      libusb_exit(NULL);
-      bInit = false;
+  return nUnits > 0;
+}
+
+bool cVFDQueue::FramePending() const {
+  for(unsigned int i = 0; i < nUnits; ++i) {
+    if(!units[i]->Busy())
+      return false;
   }
+  return nUnits > 0;
 }
 
-void cVFDQueue::QueueCmd(const unsigned char & cmd) {
-  this->push(CMD_PREFIX);
-  this->push(cmd);
+int cVFDQueue::Select(int nUnit) {
+  int n = nSelected;
+  nSelected = nUnit;
+  return n;
 }
 
 void cVFDQueue::QueueData(const unsigned char & data) {
-  this->push(data);
+  for(unsigned int i = 0; i < nUnits; ++i) {
+    if(nSelected != ALL_UNITS && nSelected != (int) i)
+      continue;
+    if(!units[i]->Packet()->push(data)) {
+      // capacity exhausted, send what's already queued
+      FlushUnit(i, false);
+      units[i]->Packet()->push(data);
+    }
+  }
 }
 
-bool cVFDQueue::QueueFlush() {
-
-  if(empty())
-    return true;
-  if(!isopen()) {
-    return false;
+void cVFDQueue::QueueData(const unsigned char* data, unsigned int n) {
+  for(unsigned int i = 0; i < nUnits; ++i) {
+    if(nSelected != ALL_UNITS && nSelected != (int) i)
+      continue;
+    unsigned int written = units[i]->Packet()->push(data, n);
+    while(written < n && FlushUnit(i, false)) {
+      written += units[i]->Packet()->push(data + written, n - written);
+    }
   }
+}
 
-	int bytes;
-	unsigned char buf[MAX_CONTROL_OUT_TRANSFER_SIZE+1];	
-  
-  while (!empty()) {
-    buf[0] = (unsigned char) std::min((size_t)MAX_CONTROL_OUT_TRANSFER_SIZE,size());
-    for(unsigned int i = 0;i < MAX_CONTROL_OUT_TRANSFER_SIZE && !empty();++i) {
-      buf[i+1] = (char) front(); //the first element in the queue
-      pop();              //remove the first element of the queue
-    }
+/**
+ * Flush the selected displays.
+ * \retval false   one of them is lost
+ */
+bool cVFDQueue::QueueFlush() {
+  bool bOk = nUnits > 0;
+  for(unsigned int i = 0; i < nUnits; ++i) {
+    if(nSelected != ALL_UNITS && nSelected != (int) i)
+      continue;
+    if(!FlushUnit(i, true))
+      bOk = false;
+  }
+  return bOk;
+}
 
-	  bytes = libusb_control_transfer(
-			  devh,
-			  CONTROL_REQUEST_TYPE_OUT ,
-			  HID_SET_REPORT,
-			  (HID_REPORT_TYPE_OUTPUT<<8)|0x00,
-			  INTERFACE_NUMBER,
-			  buf,
-			  (((int)buf[0]) + 1),
-			  TIMEOUT_MS);
-
-	  if (bytes <= 0)
-	  {
-      esyslog("targaVFD: libusb_control_transfer failed : %s (%d)",usberror(bytes),bytes);
-      while (!empty()) {
-        pop();
-      }
-      cVFDQueue::close();
+/**
+ * Send queued reports of a display. Within a frame, it's called if
+ * the packet is full, while a plan of writes may still be walked.
+ * So the state of a reconnected display is replayed only at end of
+ * frame, reports of the interrupted frame are dropped until then.
+ */
+bool cVFDQueue::FlushUnit(unsigned int n, bool bEndOfFrame) {
+  cVFDUnit* u = units[n];
+  if(!u->isopen()) {
+    if(!u->Reconnect()) {
+      u->Packet()->clear();
       return false;
-	  }
+    }
+    bResync[n] = true;
+  } else if(u->ResyncNeeded()) {
+    // watchdog has dropped a frame
+    bResync[n] = true;
   }
-  return true;
+  if(bResync[n]) {
+    // reports of interrupted frame are obsolete
+    u->Packet()->clear();
+    if(!bEndOfFrame)
+      return true;
+    // replay complete state, Resync() itself may flush within its frame
+    bResync[n] = false;
+    int s = Select(n);
+    Resync(n);
+    Select(s);
+  }
+  return u->Flush();
 }
 
-const char *cVFDQueue::usberror(int ret) const
-{
-  switch(ret) {
-    case LIBUSB_SUCCESS:
-      return "Success (no error).";
-
-    case LIBUSB_ERROR_IO:
-      return "Input/output error.";
-
-    case LIBUSB_ERROR_INVALID_PARAM: 	
-      return "Invalid parameter.";
-
-    case LIBUSB_ERROR_ACCESS:
-      return "Access denied (insufficient permissions).";
-
-    case LIBUSB_ERROR_NO_DEVICE:
-      return "No such device (it may have been disconnected).";
-
-    case LIBUSB_ERROR_NOT_FOUND:
-      return "Entity not found.";
-
-    case LIBUSB_ERROR_BUSY:
-      return "Resource busy.";
-
-    case LIBUSB_ERROR_TIMEOUT:
-      return "Operation timed out.";
-
-    case LIBUSB_ERROR_OVERFLOW:
-      return "Overflow.";
-
-    case LIBUSB_ERROR_PIPE: 	
-      return "Pipe error.";
-
-    case LIBUSB_ERROR_INTERRUPTED:
-      return "System call interrupted (perhaps due to signal).";
-
-    case LIBUSB_ERROR_NO_MEM:
-      return "Insufficient memory.";
-
-    case LIBUSB_ERROR_NOT_SUPPORTED:
-      return "Operation not supported or unimplemented on this platform.";
+unsigned int cVFDQueue::Queued() const {
+  if(nSelected == ALL_UNITS || nSelected >= (int) nUnits)
+    return 0;
+  return units[nSelected]->Packet()->size();
+}
 
-    case LIBUSB_ERROR_OTHER:
-      return "Other error. ";
-    }
-    return "unknown error";
+bool cVFDQueue::Statistic(unsigned int n, cVFDTransportStat& s, const char** szDevice) const {
+  if(n >= nUnits)
+    return false;
+  units[n]->Statistic(s);
+  if(szDevice)
+    *szDevice = units[n]->Device();
+  return true;
 }
 
 cVFD::cVFD() 
 {
   pFont = NULL;
-  lastIconState = 0;
+  m_szCells[0] = '\0';
+  m_nIconState = 0;
+  m_nBrightness = -1;
+  m_nStateBytes = 0;
+  m_nHash = 0;
+  memset(&m_OptStat, 0, sizeof(m_OptStat));
   framebuf = NULL;
-  backingstore = NULL;
+  frontbuf = NULL;
+  m_pEngine = NULL;
+  m_pDriver = NULL;
+  m_pTarget = NULL;
+  m_pColumn = NULL;
+  m_nFrames = 0;
+  m_iUnitWidth = 0;
+  m_bSpanUnits = false;
 
   m_nScrollOffset = -1;
   m_bScrollBackward = false;
@@ -294,30 +222,70 @@ bool cVFD::open()
               theSetup.m_nSmallFontHeight)) {
 		return false;
   }
-  if(!cVFDQueue::open()) {
+  return OpenPanel(theSetup.m_nDriver, theSetup.m_nTransport, theSetup.m_nUnits);
+}
+
+/**
+ * Open the displays and the buffers of a panel, the font is kept.
+ * \param nDriver     panel, see eDriver
+ * \param nTransport  backend of each display, see eTransport
+ * \param nDisplays   count of displays
+ */
+bool cVFD::OpenPanel(int nDriver, int nTransport, int nDisplays)
+{
+	/* Geometry and commands of panel, the reports of each display are sized by it */
+	this->m_pDriver = cVFDDriver::Create(nDriver);
+	isyslog("targaVFD: using driver '%s', %ux%u pixel", m_pDriver->Name(), m_pDriver->Width(), m_pDriver->Height());
+
+  if(!cVFDQueue::open(m_pDriver, nTransport, nDisplays)) {
 		return false;
   }
 
 	isyslog("targaVFD: open Device successful");
 
+	/* Displays side by side form one canvas, or show the same */
+	m_iUnitWidth = m_pDriver->Width();
+	m_bSpanUnits = theSetup.m_bSpanUnits && Units() > 1;
+
 	/* Make sure the frame buffer is there... */
-	this->framebuf = new cVFDBitmap(theSetup.m_cWidth,theSetup.m_cHeight);
-	if (this->framebuf == NULL) {
+	this->framebuf = new cVFDBitmap(m_iUnitWidth * (m_bSpanUnits ? Units() : 1), m_pDriver->Height());
+	this->frontbuf = new cVFDBitmap(m_iUnitWidth * (m_bSpanUnits ? Units() : 1), m_pDriver->Height());
+	if (this->framebuf == NULL || this->frontbuf == NULL) {
 		esyslog("targaVFD: unable to allocate framebuffer");
 		return false;
 	}
-    m_iSizeYb = ((theSetup.m_cHeight + 7) / 8);
+	this->frontbuf->ClearDamage();
 
-	/* Make sure the framebuffer backing store is there... */
-	this->backingstore = new unsigned char[theSetup.m_cWidth * m_iSizeYb];
-	if (this->backingstore == NULL) {
-		esyslog("targaVFD: unable to create framebuffer backing store");
+	/* Layers, which are composed into frame buffer */
+	for (int n = 0; n < eLayerCount; ++n) {
+		if (!m_Layer[n].Create(framebuf->Width(), framebuf->Height())) {
+			esyslog("targaVFD: unable to allocate layer");
+			return false;
+		}
+	}
+	this->m_pTarget = m_Layer[eLayerBody].Bitmap();
+	this->m_pColumn = MALLOC(uchar, framebuf->BytesPerColumn());
+	if (this->m_pColumn == NULL) {
+		esyslog("targaVFD: unable to allocate column buffer");
 		return false;
 	}
+	m_iSizeYb = m_pDriver->SizeYb();
+	this->m_pEngine = cVFDEngine::Create(m_iUnitWidth, m_pDriver->Height());
+
+	/* Make sure the shadow of each display is there... */
+	for (unsigned int u = 0; u < Units(); ++u) {
+		if (!shadow[u].Create(m_iUnitWidth, m_iSizeYb)) {
+			esyslog("targaVFD: unable to create shadow of display");
+			return false;
+		}
+	}
 
-	this->lastIconState = 0;
+	this->m_nIconState = 0;
+	this->m_nBrightness = -1;
+	this->m_nStateBytes = 0;
+	this->m_nHash = frontbuf->Hash();
 
-  QueueCmd(CMD_RESET);
+  QueueReset();
 	//Brightness(theSetup.m_nBrightness);
   if(QueueFlush()) {
   	dsyslog("targaVFD: init() done");
@@ -330,12 +298,19 @@ bool cVFD::open()
  * turning display off
  */
 bool cVFD::SendCmdShutdown() {
-  QueueCmd(CMD_RESET);
+  QueueReset();
 	return QueueFlush();
 }
 
-inline unsigned char toBCD(int x){ 
- return (unsigned char)(((x) / 10 * 16) + ((x) % 10));
+/**
+ * Queue a reset to the selected displays, they clear RAM and symbols.
+ */
+void cVFD::QueueReset() {
+  unsigned char cmd[cVFDDriver::MAX_COMMAND];
+  QueueData(cmd, m_pDriver->EncodeReset(cmd));
+  for (unsigned int u = 0; u < Units(); ++u)
+    if (Selected(u))
+      shadow[u].Reset(m_pDriver->DimmReset());
 }
 
 /*
@@ -350,14 +325,23 @@ bool cVFD::SendCmdClock() {
   tt = time(NULL);
   localtime_r(&tt, &l);
 
-  // Set time
-  QueueCmd(CMD_SETCLOCK);
-  QueueData(toBCD(l.tm_min));
-  QueueData(toBCD(l.tm_hour));
+  unsigned char cmd[cVFDDriver::MAX_COMMAND];
+  for (unsigned int u = 0; u < Units(); ++u) {
+    int s = Select(u);
+    QueueState(u);
+
+    // Set time
+    QueueData(cmd, m_pDriver->EncodeSetClock(cmd, l.tm_hour, l.tm_min));
 
-  // Show it
-  QueueCmd(CMD_BIGCLOCK);
-  QueueData(TIME_24);
+    // Show it
+    if (shadow[u].Clock() < 0) {
+      unsigned int n = m_pDriver->EncodeShowClock(cmd);
+      QueueData(cmd, n);
+      if (n)
+        shadow[u].Clock(1);
+    }
+    Select(s);
+  }
   return QueueFlush();
 }
 
@@ -376,81 +360,371 @@ void cVFD::close()
     delete framebuf;
     framebuf = NULL;
   }
-  if(backingstore) {
-    delete[] backingstore;
-    backingstore = NULL;
+  if(frontbuf) {
+    delete frontbuf;
+    frontbuf = NULL;
+  }
+  for (int n = 0; n < eLayerCount; ++n)
+    m_Layer[n].Destroy();
+  for (int f = 0; f < MAX_FRAMES; ++f)
+    for (int n = 0; n < eLayerCount; ++n)
+      m_Frame[f].layer[n].Destroy();
+  m_nFrames = 0;
+  m_pTarget = NULL;
+  if(m_pColumn) {
+    free(m_pColumn);
+    m_pColumn = NULL;
   }
+  if(m_pEngine) {
+    delete m_pEngine;
+    m_pEngine = NULL;
+  }
+  if(m_pDriver) {
+    delete m_pDriver;
+    m_pDriver = NULL;
+  }
+  for (unsigned int u = 0; u < MAX_UNITS; ++u)
+    shadow[u].Destroy();
 
 	dsyslog("targaVFD: close() done");
 }
 
 
 /**
- * Clear the screen.
+ * Clear the screen, all layers are emptied. Following drawing goes
+ * to the body, which cover the whole screen.
  */
 void cVFD::clear()
 {
-  if(framebuf)
-    framebuf->clear();
+  for (int n = 0; n < eLayerCount; ++n)
+    m_Layer[n].Reset();
+  m_pTarget = m_Layer[eLayerBody].Bitmap();
+}
+
+/**
+ * Save the current screen, before it's covered e.g. by an OSD.
+ */
+bool cVFD::PushFrame()
+{
+  if (m_nFrames >= MAX_FRAMES || !framebuf)
+    return false;
+  cVFDFrame& f = m_Frame[m_nFrames++];
+  for (int n = 0; n < eLayerCount; ++n)
+    f.layer[n] = m_Layer[n];
+  strcpy(f.szCells, m_szCells);
+  f.nScrollOffset = m_nScrollOffset;
+  f.bScrollBackward = m_bScrollBackward;
+  f.bScrollNeeded = m_bScrollNeeded;
+  return true;
+}
+
+/**
+ * Restore the screen of last PushFrame(). Only columns, which differ
+ * from the current screen, are sent with next flush.
+ */
+bool cVFD::PopFrame()
+{
+  if (m_nFrames <= 0 || !framebuf)
+    return false;
+  const cVFDFrame& f = m_Frame[--m_nFrames];
+  for (int n = 0; n < eLayerCount; ++n)
+    m_Layer[n] = f.layer[n];
+  strcpy(m_szCells, f.szCells);
+  m_nScrollOffset = f.nScrollOffset;
+  m_bScrollBackward = f.bScrollBackward;
+  m_bScrollNeeded = f.bScrollNeeded;
+  m_pTarget = m_Layer[eLayerBody].Bitmap();
+  return true;
+}
+
+/**
+ * Direct following drawing to a layer.
+ */
+void cVFD::SelectLayer(int nLayer)
+{
+  if (nLayer >= 0 && nLayer < eLayerCount)
+    m_pTarget = m_Layer[nLayer].Bitmap();
+}
+
+/**
+ * Restrict a layer to a region of the screen.
+ */
+void cVFD::LayerBounds(int nLayer, int x1, int y1, int x2, int y2)
+{
+  if (nLayer >= 0 && nLayer < eLayerCount)
+    m_Layer[nLayer].Bounds(x1, y1, x2, y2);
+}
+
+/**
+ * Check, if a layer have to be drawn again, because the content has changed.
+ * \param szKey    describe content, e.g. the shown text
+ */
+bool cVFD::LayerChanged(int nLayer, const char* szKey)
+{
+  if (nLayer < 0 || nLayer >= eLayerCount)
+    return false;
+  return m_Layer[nLayer].Changed(szKey);
+}
+
+/**
+ * Remove all pixels of a layer, before it's drawn again.
+ */
+void cVFD::ClearLayer(int nLayer)
+{
+  if (nLayer >= 0 && nLayer < eLayerCount)
+    m_Layer[nLayer].clear();
+}
+
+/**
+ * Compose the columns, which are damaged in any layer, into the frame
+ * buffer. A column of the frame buffer is damaged only if it changes, 
+ * so a redrawn layer with the same pixels doesn't cause a transfer.
+ */
+void cVFD::Compose()
+{
+  bool bDamaged = false;
+  for (int n = 0; n < eLayerCount; ++n)
+    bDamaged |= m_Layer[n].Damaged();
+  if (!bDamaged)
+    return;
+
+  const unsigned int nBytes = framebuf->BytesPerColumn();
+  for (int x = 0; x < framebuf->Width(); ++x) {
+    bool bColumn = false;
+    for (int n = 0; n < eLayerCount && !bColumn; ++n)
+      bColumn = m_Layer[n].Damaged() && m_Layer[n].Bitmap()->getDamage()[x];
+    if (!bColumn)
+      continue;
+    memset(m_pColumn, 0x00, nBytes);
+    for (int n = 0; n < eLayerCount; ++n) {
+      const uchar* src = m_Layer[n].Bitmap()->getBitmap() + (x * nBytes);
+      for (unsigned int yb = 0; yb < nBytes; ++yb)
+        m_pColumn[yb] |= src[yb];
+    }
+    framebuf->SetColumn(x, m_pColumn);
+  }
+  for (int n = 0; n < eLayerCount; ++n)
+    m_Layer[n].Bitmap()->ClearDamage();
 }
 
 
 /**
  * Flush cached bitmap data and submit changes rows to the Display.
+ * Displays, which are still busy with a previous frame, are skipped.
+ * There keep their changes for the next flush.
  */
 
 bool cVFD::flush(bool refreshAll)
 {
-  unsigned int n, x, yb;
-
-  if (!backingstore || !framebuf)
+  if (!framebuf || !frontbuf)
       return false;
 
-  const uchar* fb = framebuf->getBitmap();
-  const unsigned int width = framebuf->Width();
-
-  bool doRefresh = false;
-  unsigned int minX = width;
-  unsigned int maxX = 0;
-
-  for (yb = 0; yb < m_iSizeYb; ++yb)
-      for (x = 0; x < width; ++x)
-      {
-          n = x + (yb * width);
-          if (*(fb + n) != *(backingstore + n))
-          {
-              *(backingstore + n) = *(fb + n);
-              minX = min(minX, x);
-              maxX = max(maxX, x + 1);
-              doRefresh = true;
-          }
-      }
-
-  if (refreshAll || doRefresh) {
-    if (refreshAll) {
-      minX = 0;
-      maxX = width;
+  Compose();
+  commit();
+  DamageUnits();
+
+  bool bOk = true;
+  bool bFrame = false;
+  unsigned int nBytesSaved = 0;
+  unsigned int nReportsSaved = 0;
+  for (unsigned int u = 0; u < Units(); ++u) {
+    if (!refreshAll && UnitBusy(u))
+      continue;
+    int s = Select(u);
+    unsigned int nSent = QueueState(u);
+    unsigned int nData = QueueChanges(u, refreshAll);
+
+    // without shadow, each call of icons() and Brightness() is queued
+    unsigned int nNaive = m_nStateBytes + nData;
+    nSent += nData;
+    if (nNaive > nSent) {
+      nBytesSaved += nNaive - nSent;
+      nReportsSaved += ((nNaive + cVFDPacket::PAYLOAD - 1) / cVFDPacket::PAYLOAD)
+                     - ((nSent + cVFDPacket::PAYLOAD - 1) / cVFDPacket::PAYLOAD);
     }
+    if (!QueueFlush())
+      bOk = false;
+    Select(s);
+    bFrame = true;
+  }
+  if (bFrame) {
+    m_nStateBytes = 0;
+    ++m_OptStat.nFrames;
+    m_OptStat.nBytesSaved += nBytesSaved;
+    m_OptStat.nReportsSaved += nReportsSaved;
+    m_OptStat.nLastBytesSaved = nBytesSaved;
+    m_OptStat.nLastReportsSaved = nReportsSaved;
+  }
+  return bOk;
+}
 
-    maxX = min(maxX, width);
-
-	  unsigned int nData = (maxX-minX) * m_iSizeYb;
-	  if(nData) {
-	    // send data to display, controller
-		QueueCmd(CMD_SETRAM);
-		QueueData(minX*m_iSizeYb);
-		QueueCmd(CMD_SETPIXEL);
-		QueueData(nData);
-
-    for (x = minX; x < maxX; ++x)
-	    for (yb = 0; yb < m_iSizeYb; ++yb)
-        {
-            n = x + (yb * width);
-            QueueData((*(backingstore + n)));
-        }
-		}
+/**
+ * Publish the drawn frame by swap of buffers. Afterwards the damaged 
+ * columns are copied back, so drawing continues on the same contents.
+ */
+void cVFD::commit()
+{
+  if (!framebuf->Damaged())
+    return;
+  cVFDBitmap* p = frontbuf;
+  frontbuf = framebuf;
+  framebuf = p;
+  framebuf->CopyDamaged(*frontbuf);
+}
+
+/**
+ * Pass damaged columns of published frame to the shadow of each display. 
+ * If the canvas was redrawn with the same contents, nothing is passed.
+ */
+void cVFD::DamageUnits()
+{
+  if (!frontbuf->Damaged())
+    return;
+
+  uint64_t nHash = frontbuf->Hash();
+  if (nHash != m_nHash) {
+    m_nHash = nHash;
+    const uchar* damage = frontbuf->getDamage();
+    for (unsigned int u = 0; u < Units(); ++u) {
+      const uchar* d = damage + UnitOffset(u);
+      for (unsigned int x = 0; x < m_iUnitWidth; ++x)
+        if (d[x])
+          shadow[u].Invalidate(x);
+    }
   }
-  return QueueFlush();
+  frontbuf->ClearDamage();
+}
+
+/**
+ * Queue symbols and dimming level, which differ from the shadow of display.
+ * Changes between two frames are merged, only the last state is sent.
+ * \return count of queued bytes
+ */
+unsigned int cVFD::QueueState(unsigned int nUnit)
+{
+  cVFDShadow& sh = shadow[nUnit];
+  unsigned char cmd[cVFDDriver::MAX_COMMAND];
+  unsigned int nBytes = 0;
+
+  if (m_nBrightness >= 0 && m_nBrightness != sh.Dimm()) {
+    unsigned int n = m_pDriver->EncodeDimm(cmd, m_nBrightness);
+    QueueData(cmd, n);
+    sh.Dimm(m_nBrightness);
+    nBytes += n;
+  }
+
+  unsigned int changed = m_nIconState ^ sh.Symbols();
+  for (unsigned i = 0; changed && i < m_pDriver->Symbols(); i++) {
+    if (changed & (1 << i)) {
+      unsigned int n = m_pDriver->EncodeSymbol(cmd, i, (m_nIconState & (1 << i)) != 0);
+      QueueData(cmd, n);
+      changed &= ~(1 << i);
+      nBytes += n;
+    }
+  }
+  sh.Symbols(m_nIconState);
+  return nBytes;
+}
+
+/**
+ * Queue the part of canvas, which is shown by one display and 
+ * differs from its shadow. Changed columns are written by the
+ * cheapest set of writes, see cVFDPlanner.
+ * \return count of queued bytes
+ */
+unsigned int cVFD::QueueChanges(unsigned int nUnit, bool refreshAll)
+{
+  cVFDShadow& sh = shadow[nUnit];
+  if (refreshAll) {
+    sh.Validate();
+    UpdateShadow(nUnit, 0, m_iUnitWidth);
+    return QueueColumns(nUnit, 0, m_iUnitWidth);
+  }
+  // nothing drawn since last flush
+  if (!sh.Stale())
+    return 0;
+
+  // compare only runs of damaged columns
+  m_Planner.clear(m_iSizeYb, m_pDriver->WriteHeader(), m_pDriver->MaxWrite());
+  for (unsigned int x = 0; x < m_iUnitWidth;) {
+    if (!sh.Stale(x)) {
+      ++x;
+      continue;
+    }
+    unsigned int end = x + 1;
+    while (end < m_iUnitWidth && sh.Stale(end))
+      ++end;
+    DiffColumns(nUnit, x, end);
+    x = end;
+  }
+  sh.Validate();
+
+  unsigned int nBytes = 0;
+  unsigned int nSpans = m_Planner.Plan(Queued());
+  for (unsigned int i = 0; i < nSpans; ++i) {
+    const cVFDSpan& span = m_Planner.Span(i);
+    UpdateShadow(nUnit, span.minX, span.maxX);
+    nBytes += QueueColumns(nUnit, span.minX, span.maxX);
+  }
+  return nBytes;
+}
+
+/**
+ * Pass changed columns within [minX, maxX) to planner. Canvas and 
+ * shadow share the column layout, so the range is compared 64 bit 
+ * at once by the engine of the geometry.
+ */
+void cVFD::DiffColumns(unsigned int nUnit, unsigned int minX, unsigned int maxX)
+{
+  m_pEngine->Diff(UnitCanvas(nUnit), UnitBackingstore(nUnit), minX, maxX, m_Planner);
+}
+
+/**
+ * Take columns [minX, maxX) of canvas into shadow of display.
+ */
+void cVFD::UpdateShadow(unsigned int nUnit, unsigned int minX, unsigned int maxX)
+{
+  m_pEngine->Copy(UnitCanvas(nUnit), UnitBackingstore(nUnit), minX, maxX);
+}
+
+/**
+ * Queue columns [minX, maxX) from shadow to the display RAM, split
+ * into writes of at most MaxWrite() bytes of the driver.
+ * \return count of queued bytes
+ */
+unsigned int cVFD::QueueColumns(unsigned int nUnit, unsigned int minX, unsigned int maxX)
+{
+  const unsigned char* bs = UnitBackingstore(nUnit);
+  const unsigned int nStep = max(m_pDriver->MaxWrite() / m_iSizeYb, 1U);
+  unsigned char cmd[cVFDDriver::MAX_COMMAND];
+  unsigned int nBytes = 0;
+
+  for (unsigned int x = minX; x < maxX; x += nStep) {
+    unsigned int nData = (min(x + nStep, maxX) - x) * m_iSizeYb;
+    // send data to display, controller
+    unsigned int n = m_pDriver->EncodeWrite(cmd, x * m_iSizeYb, nData);
+    QueueData(cmd, n);
+    // shadow has the layout of RAM, copied at once into reports
+    QueueData(bs + (x * m_iSizeYb), nData);
+    nBytes += n + nData;
+  }
+  // graphics replace a shown clock
+  if (nBytes)
+    shadow[nUnit].Clock(-1);
+  return nBytes;
+}
+
+/**
+ * Replay the whole state of display, after it was reconnected.
+ * The display has lost all, so it's reset and contents, symbols
+ * and brightness are sent again.
+ */
+void cVFD::Resync(unsigned int nUnit)
+{
+  QueueReset();
+  QueueState(nUnit);
+  if (frontbuf)
+    QueueChanges(nUnit, false);
 }
 
 /**
@@ -462,11 +736,55 @@ bool cVFD::flush(bool refreshAll)
  */
 int cVFD::DrawText(int x, int y, const char* string, int nMaxWidth /* = 1024*/)
 {
-  if(pFont && framebuf)
-    return pFont->DrawText(framebuf, x, y, string, nMaxWidth);
+  if(pFont && m_pTarget)
+    return pFont->DrawText(m_pTarget, x, y, string, nMaxWidth);
   return -1;
 }
 
+/**
+ * Draw a string of digits and separators centered, by cells which are 
+ * rendered at load of font. Only cells, whose character has changed 
+ * since last call, are drawn again.
+ * \param y        Vertical position (row).
+ * \param string   String that gets written.
+ * \return false, if a character has no cell
+ */
+bool cVFD::DrawCells(int y, const char* string)
+{
+  if(!pFont || !m_pTarget || strlen(string) > MAX_CELLS || !m_Digits.Has(string))
+    return false;
+
+  int x = max((this->Width() - m_Digits.Width(string)) / 2, 0);
+
+  // layout is kept, as long as separators stay at their place
+  char szKey[MAX_CELLS + 32];
+  int n = snprintf(szKey, sizeof(szKey), "cells %d %d ", x, y);
+  for(const char* c = string; *c && n < (int) sizeof(szKey) - 1; ++c)
+    szKey[n++] = (*c >= '0' && *c <= '9') ? '0' : *c;
+  szKey[n] = '\0';
+  bool bFull = LayerChanged(eLayerBody, szKey);
+
+  // last string has the same layout, unless it was reset meanwhile
+  const char* szLast = strlen(m_szCells) == strlen(string) ? m_szCells : NULL;
+  if(bFull) {
+    ClearLayer(eLayerBody);
+    LayerBounds(eLayerBody, 0, 0, this->Width() - 1, this->Height() - 1);
+  }
+  SelectLayer(eLayerBody);
+  for(const char* c = string; *c; ++c) {
+    const cVFDBitmap* b = m_Digits.Cell(*c);
+    bool bChanged = bFull || !szLast || szLast[c - string] != *c;
+    if(bChanged) {
+      if(!bFull)
+        m_pTarget->Erase(x, y, x + b->Width() - 1, y + b->Height() - 1);
+      m_pTarget->Blit(x, y, b->getBitmap(), b->Width(), b->Height());
+    }
+    x += b->Width();
+  }
+  strcpy(m_szCells, string);
+  return true;
+}
+
 int cVFD::DrawTextEclipsed(int x, int y, const char* string, int nMaxWidth /* = 1024*/)
 {
   static const char* szEclipse = "..";
@@ -560,11 +878,31 @@ int cVFD::Width() const
  */
 bool cVFD::Rectangle(int x1, int y1, int x2, int y2, bool filled)
 {
-  if(framebuf)
-    return framebuf->Rectangle(x1, y1, x2, y2, filled);
+  if(m_pTarget)
+    return m_pTarget->Rectangle(x1, y1, x2, y2, filled);
   return false;
 }
 
+/**
+ * Restrict all following drawing to a region, until PopClip().
+ * \param x1       First horizontal corner (column).
+ * \param y1       First vertical corner (row).
+ * \param x2       Second horizontal corner (column).
+ * \param y2       Second vertical corner (row).
+ */
+bool cVFD::PushClip(int x1, int y1, int x2, int y2)
+{
+  if(m_pTarget)
+    return m_pTarget->PushClip(x1, y1, x2, y2);
+  return false;
+}
+
+void cVFD::PopClip()
+{
+  if(m_pTarget)
+    m_pTarget->PopClip();
+}
+
 
 /**
  * Sets the "icons state" for the device. We use this to control the icons
@@ -574,15 +912,15 @@ bool cVFD::Rectangle(int x1, int y1, int x2, int y2, bool filled)
  */
 void cVFD::icons(unsigned int state)
 {
-  for(unsigned i = 0; i <= 0x18; i++) {
-    if((state & (1 << i)) != (lastIconState & (1 << i))) 
-    { 
-      QueueCmd(CMD_SETSYMBOL);
-      QueueData(i);
-      QueueData((state & (1 << i)) ? STATE_ON : STATE_OFF );
+  // sent with next flush, see QueueState()
+  if(m_pDriver) {
+    unsigned char cmd[cVFDDriver::MAX_COMMAND];
+    for(unsigned i = 0; i < m_pDriver->Symbols(); i++) {
+      if((state & (1 << i)) != (m_nIconState & (1 << i))) 
+        m_nStateBytes += m_pDriver->EncodeSymbol(cmd, i, false);
     }
-  }  
-  lastIconState = state;
+  }
+  m_nIconState = state;
 }
 
 /**
@@ -593,13 +931,24 @@ void cVFD::icons(unsigned int state)
  */
 void cVFD::Brightness(int nBrightness)
 {
+	if (!m_pDriver)
+		return;
 	if (nBrightness < 0) {
 		nBrightness = 0;
-	} else if (nBrightness > 2) {
-		nBrightness = 2;
+	} else if (nBrightness > m_pDriver->DimmMax()) {
+		nBrightness = m_pDriver->DimmMax();
 	}
-  this->QueueCmd(CMD_SETDIMM);
-  this->QueueData((unsigned char) (nBrightness));
+  // sent with next flush, see QueueState()
+  unsigned char cmd[cVFDDriver::MAX_COMMAND];
+  m_nBrightness = nBrightness;
+  m_nStateBytes += m_pDriver->EncodeDimm(cmd, nBrightness);
+}
+
+bool cVFD::GlyphCacheStatistic(cVFDGlyphCacheStat& s) const {
+  if(!pFont)
+    return false;
+  pFont->CacheStatistic(s);
+  return true;
 }
 
 bool cVFD::SetFont(const char *szFont, bool bTwoLineMode, int nBigFontHeight, int nSmallFontHeight) {
@@ -610,18 +959,34 @@ bool cVFD::SetFont(const char *szFont, bool bTwoLineMode, int nBigFontHeight, in
   if(!isempty(sFileName))
   {
     if (bTwoLineMode) {
-      tmpFont = new cVFDFont(sFileName,nSmallFontHeight);
+      tmpFont = new cVFDFont(sFileName,nSmallFontHeight,0,theSetup.m_szCacheDir);
     } else {
-      tmpFont = new cVFDFont(sFileName,nBigFontHeight);
+      tmpFont = new cVFDFont(sFileName,nBigFontHeight,0,theSetup.m_szCacheDir);
     }
   } else {
 		esyslog("targaVFD: unable to find font '%s'",szFont);
   }
   if(tmpFont) {
+    tmpFont->SetCacheLimit(theSetup.m_nGlyphCache * 1024);
+    // fonts for missing characters, in order of setup
+    char* szList = strdup(theSetup.m_szFallbackFont);
+    char* strtok_next;
+    for(char* p = strtok_r(szList, ",", &strtok_next); p; p = strtok_r(NULL, ",", &strtok_next)) {
+      p = skipspace(stripspace(p));
+      cString sFallback = cFont::GetFontFileName(p);
+      if(isempty(sFallback))
+        esyslog("targaVFD: unable to find fallback font '%s'", p);
+      else
+        tmpFont->AddFallback(sFallback);
+    }
+    free(szList);
     if(pFont) {
       delete pFont;
     }
     pFont = tmpFont;
+    // cells of clock and replay time
+    m_Digits.Create(pFont);
+    m_szCells[0] = '\0';
     return true;
   }
   return false;
@@ -14,9 +14,16 @@
 #ifndef __VFD_H_
 #define __VFD_H_
 
-#include <queue>
-#include <libusb-1.0/libusb.h>
+#include <vdr/tools.h>
 #include "bitmap.h"
+#include "setup.h"
+#include "unit.h"
+#include "shadow.h"
+#include "planner.h"
+#include "engine.h"
+#include "driver.h"
+#include "layer.h"
+#include "digits.h"
 
 enum eIcons {
   eIconOff = 0,
@@ -47,32 +54,114 @@ enum eIcons {
   eIconVOL14        = 1 << 0x18  // Volume level 14 of 14
 };
 
-class cVFDFont;
+/* Layers, composed from bottom to top */
+enum eLayer {
+   eLayerBody       /**< main text, whole screen if there no header */
+  ,eLayerHeader     /**< first line of dual line mode */
+  ,eLayerSpectrum   /**< spectrum analyzer */
+  ,eLayerOverlay    /**< e.g. current time above the header */
+  ,eLayerCount
+};
+
+/* longest string of DrawCells(), e.g. "12:34" or "1:23:45 / 2:34:56" */
+#define MAX_CELLS 31
 
-class cVFDQueue : public std::queue<unsigned char> {
-  struct libusb_device_handle* devh;
-    bool bInit;
+/*
+ * Saved screen, e.g. while an OSD is shown
+ */
+struct cVFDFrame {
+  cVFDLayer layer[eLayerCount];
+  char  szCells[MAX_CELLS + 1];
+  int   nScrollOffset;
+  bool  bScrollBackward;
+  bool  bScrollNeeded;
+};
+
+class cVFDFont;
+struct cVFDGlyphCacheStat;
+
+class cVFDQueue {
+  cVFDUnit* units[MAX_UNITS];
+  unsigned int nUnits;
+  int nSelected;  ///< unit addressed by QueueData, or ALL_UNITS
+  bool bResync[MAX_UNITS];  ///< state of display is replayed at end of frame
+  bool FlushUnit(unsigned int n, bool bEndOfFrame);
 public:
+  enum { ALL_UNITS = -1 };
+
   cVFDQueue();
   virtual ~cVFDQueue();
+  /** count of configured displays */
+  unsigned int Units() const { return nUnits; }
+  /** counters of a display, false if there none */
+  bool Statistic(unsigned int n, cVFDTransportStat& s, const char** szDevice = NULL) const;
 protected:
-  virtual bool open();
+  bool open(const cVFDDriver* pDriver, int nTransport, int nDisplays);
   virtual void close();
-  virtual bool isopen() const { return devh != NULL; }
-  void QueueCmd(const unsigned char & cmd);
+  virtual bool isopen() const;
+  /** address all following commands to one display, returns the previous selection */
+  int Select(int nUnit);
+  /** true, if display is addressed by QueueData */
+  bool Selected(unsigned int n) const { return nSelected == ALL_UNITS || nSelected == (int) n; }
   void QueueData(const unsigned char & data);
+  void QueueData(const unsigned char* data, unsigned int n);
   bool QueueFlush();
-private:
-  const char *usberror(int ret) const;
+  /** bytes, which are queued for the selected display */
+  unsigned int Queued() const;
+  /** queue the complete state of a display, after it was reconnected */
+  virtual void Resync(unsigned int nUnit) {}
+  /** true, while reports of a previous frame are still on the bus of every display */
+  bool FramePending() const;
+  /** true, while reports of a previous frame are still on the bus of this display */
+  bool UnitBusy(unsigned int n) const { return n < nUnits && units[n]->Busy(); }
+  /** last frame, which was completely transferred to the first display */
+  unsigned int FrameCompleted() const { return nUnits ? units[0]->FrameCompleted() : 0; }
+  /** count of reports, which was produced by last flush of the first display */
+  unsigned int ReportsLastFrame() const { return nUnits ? units[0]->ReportsLastFrame() : 0; }
+  /** backend of a display, NULL if there none */
+  cVFDTransport* Transport(unsigned int n) const { return n < nUnits ? units[n]->Transport() : NULL; }
+};
+
+/*
+ * Counters of command optimizer, bytes and reports a frame would
+ * need without the shadow of the display state
+ */
+struct cVFDOptimizerStat {
+  unsigned long nFrames;
+  unsigned long nBytesSaved;
+  unsigned long nReportsSaved;
+  unsigned int  nLastBytesSaved;   ///< saved by last frame
+  unsigned int  nLastReportsSaved; ///< saved by last frame
 };
 
 class cVFD : public cVFDQueue {
 
-	/* framebuffer and backingstore for current contents */
+	/* framebuffer to draw, published frame and shadow of each display */
 	cVFDBitmap* framebuf;
-	unsigned char * backingstore;
-	unsigned int lastIconState;
+	cVFDBitmap* frontbuf;
+	cVFDShadow shadow[MAX_UNITS];
+	cVFDLayer m_Layer[eLayerCount];
+	cVFDBitmap* m_pTarget;       ///< bitmap of layer, which is drawn
+	uchar* m_pColumn;            ///< scratch column of Compose()
+	cVFDDigits m_Digits;         ///< cells of clock and replay time
+	char m_szCells[MAX_CELLS + 1]; ///< string of last DrawCells(), empty if none
+
+	enum { MAX_FRAMES = 4 };
+	cVFDFrame m_Frame[MAX_FRAMES];
+	int m_nFrames;
+	unsigned int m_nIconState;   ///< wanted symbols, sent with next flush
 	unsigned int m_iSizeYb;
+	unsigned int m_iUnitWidth;  ///< columns of one display
+	bool  m_bSpanUnits;          ///< displays side by side form one canvas
+  int   m_nBrightness;            ///< wanted dimming level, sent with next flush
+
+  cVFDPlanner m_Planner;
+  cVFDEngine* m_pEngine;         ///< diff and copy of columns, specialized for geometry
+  cVFDDriver* m_pDriver;         ///< geometry and commands of panel
+  uint64_t m_nHash;              ///< hash of canvas, when damage was passed last time
+
+  unsigned int m_nStateBytes;    ///< bytes, which icons() and Brightness() would have queued
+  cVFDOptimizerStat m_OptStat;
 
   int   m_nScrollOffset;
   bool  m_bScrollBackward;
@@ -83,7 +172,24 @@ protected:
 
   bool SendCmdClock();
   bool SendCmdShutdown();
+  bool OpenPanel(int nDriver, int nTransport, int nDisplays);
+  void QueueReset();
   void Brightness(int nBrightness);
+  void Compose();
+  void commit();
+  void DamageUnits();
+  unsigned int QueueChanges(unsigned int nUnit, bool refreshAll);
+  void DiffColumns(unsigned int nUnit, unsigned int minX, unsigned int maxX);
+  void UpdateShadow(unsigned int nUnit, unsigned int minX, unsigned int maxX);
+  unsigned int QueueState(unsigned int nUnit);
+  unsigned int QueueColumns(unsigned int nUnit, unsigned int minX, unsigned int maxX);
+  virtual void Resync(unsigned int nUnit);
+  /** first column of canvas, which is shown by a display */
+  unsigned int UnitOffset(unsigned int nUnit) const { return m_bSpanUnits ? nUnit * m_iUnitWidth : 0; }
+  /** bytes of canvas shown by a display, starting at its first column in the layout of RAM */
+  const uchar* UnitCanvas(unsigned int nUnit) const { return frontbuf->getBitmap() + (UnitOffset(nUnit) * m_iSizeYb); }
+  /** RAM of a display, it's compared with the canvas */
+  unsigned char* UnitBackingstore(unsigned int nUnit) const { return shadow[nUnit].RAM(); }
 public:
   cVFD();
   virtual ~cVFD();
@@ -95,6 +201,7 @@ public:
   void clear ();
   int DrawText(int x, int y, const char* string, int nMaxWidth = 1024);
   int DrawTextEclipsed(int x, int y, const char* string, int nMaxWidth = 1024);
+  bool DrawCells(int y, const char* string);
 
   int DrawTextScrolled(int x, int y, const char* string, bool bCenter);
   inline bool NeedScrolled() const { return m_nScrollOffset > 0 || m_bScrollBackward; };
@@ -103,9 +210,24 @@ public:
   int Height() const;
   int Width() const;
   bool Rectangle(int x1, int y1, int x2, int y2, bool filled);
+  bool PushClip(int x1, int y1, int x2, int y2);
+  void PopClip();
+
+  bool PushFrame();
+  bool PopFrame();
+
+  void SelectLayer(int nLayer);
+  void LayerBounds(int nLayer, int x1, int y1, int x2, int y2);
+  bool LayerChanged(int nLayer, const char* szKey);
+  void ClearLayer(int nLayer);
   bool flush (bool refreshAll = true);
 
   void icons(unsigned int state);
+  const cVFDOptimizerStat& OptimizerStatistic() const { return m_OptStat; }
+  /** engine of diff, NULL while closed */
+  const cVFDEngine* Engine() const { return m_pEngine; }
+  /** counters of glyph cache, false if there no font */
+  bool GlyphCacheStatistic(cVFDGlyphCacheStat& s) const;
   virtual bool SetFont(const char *szFont, bool bTwoLineMode, int nBigFontHeight, int nSmallFontHeight);
 };
 
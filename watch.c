@@ -69,6 +69,8 @@ cVFDWatch::cVFDWatch()
 
   currentTime = NULL;
   m_eWatchMode = eLiveTV;
+  m_bOsdFrame = false;
+  m_bFrameStale = false;
 }
 
 cVFDWatch::~cVFDWatch()
@@ -120,9 +122,11 @@ cVFDWatch::~cVFDWatch()
 }
 
 bool cVFDWatch::open() {
+  cMutexLooker m(m_Mutex);
   if(cVFD::open()) {
     m_bShutdown = false;
     m_bUpdateScreen = true;
+    m_bOsdFrame = false;
     Start();
     return true;
   }
@@ -137,6 +141,8 @@ void cVFDWatch::shutdown(int nExitMode) {
     Cancel();
   }
 
+  // units, engine and font are released, while statistics may be read
+  cMutexLooker m(m_Mutex);
   if(this->isopen()) {
 
     switch(nExitMode) {
@@ -144,7 +150,7 @@ void cVFDWatch::shutdown(int nExitMode) {
       case eOnExitMode_NEXTTIMER_BLANKSCR: {
         isyslog("targaVFD: closing, show only next timer.");
 
-        int nTop = (theSetup.m_cHeight - pFont->Height())/2;
+        int nTop = (this->Height() - pFont->Height())/2;
         this->clear();
 
         const cTimer* t = NULL;
@@ -174,12 +180,12 @@ void cVFDWatch::shutdown(int nExitMode) {
           int w = pFont->Width(topic);
           if(theSetup.m_nRenderMode == eRenderMode_DualLine) {
             this->DrawText(0,0,topic);
-            if((w + 3) < theSetup.m_cWidth)
+            if((w + 3) < this->Width())
                 this->DrawText(w + 3,0,t->Channel()->Name());
             this->DrawText(0,pFont->Height(), t->File());
           } else {
             this->DrawText(0,nTop<0?0:nTop, topic);
-            if((w + 3) < theSetup.m_cWidth)
+            if((w + 3) < this->Width())
                 this->DrawText(w + 3,nTop<0?0:nTop, t->File());
           }
           this->icons(eIconRECORD);
@@ -224,6 +230,7 @@ void cVFDWatch::Action(void)
   cTimeMs runTime;
   struct tm tm_r;
   bool bLastSuspend = false;
+  bool bFlushPending = false;
 
   for (;!m_bShutdown;++nCnt) {
     
@@ -263,9 +270,22 @@ void cVFDWatch::Action(void)
         bReDraw = true;
         bFlush= true;
         bLastSuspend = bSuspend;
+        m_bFrameStale = true;
       }
 
       if(!bSuspend) { 
+          // keep screen below an OSD, restore it after OSD is closed
+          bool bOsd = osdMessage || osdTitle || osdItem;
+          if(bOsd != m_bOsdFrame) {
+            if(bOsd) {
+              m_bFrameStale = !PushFrame();
+            } else if(PopFrame() && !m_bFrameStale) {
+              m_bUpdateScreen = false;
+              bFlush = true;
+            }
+            m_bOsdFrame = bOsd;
+          }
+
           // every 300ms the clock need updates.
           if((0 == (nCnt % 3))) {
             bReDraw = ( theSetup.m_nRenderMode == eRenderMode_MultiPage )
@@ -277,13 +297,16 @@ void cVFDWatch::Action(void)
                m_nReplayCurrent = ts - chPresentTime;
                m_nReplayTotal = chFollowingTime - chPresentTime;
             }
+            // time changed below the OSD, the saved screen is outdated
+            if(bReDraw && m_bOsdFrame)
+              m_bFrameStale = true;
         }
 
         switch(theSetup.m_nRenderMode) {
           case eRenderMode_SingleLine:
           case eRenderMode_DualLine:
           case eRenderMode_SingleTopic:
-            bFlush = RenderScreenSinglePage(bReDraw);
+            bFlush |= RenderScreenSinglePage(bReDraw);
             break;
           case eRenderMode_MultiPage:
             // every 15s the Pages should rotated.
@@ -291,8 +314,9 @@ void cVFDWatch::Action(void)
               nPage ++;
               nPage %= nMaxPages;
               m_bUpdateScreen = true;
+              m_bFrameStale = true;
             }
-            bFlush = RenderScreenPages(bReDraw, nPage, nMaxPages);
+            bFlush |= RenderScreenPages(bReDraw, nPage, nMaxPages);
             break;
         }
      }
@@ -374,8 +398,12 @@ void cVFDWatch::Action(void)
         bFlush = true;
       }
 
-      if(bFlush) {
-        flush(false);
+      // a lost display is reconnected by flush, without waiting for changes
+      if(bFlush || bFlushPending || !isopen()) {
+        // don't stall on the bus, while the previous frame is still in transfer
+        bFlushPending = FramePending();
+        if(!bFlushPending)
+          flush(false);
       }
     }
     int nDelay = (bSuspend ? 1000 : 100) - runTime.Elapsed();
@@ -426,25 +454,15 @@ bool cVFDWatch::RenderScreenSinglePage(bool bReDraw) {
     if(bForce) {
       this->RestartScrolled();
     }
+    if(theSetup.m_nRenderMode == eRenderMode_DualLine)
+      return RenderScreenDualLine(bForce, bReDraw, scHeader, scRender, 
+                                  bAllowCurrentTime ? currentTime : NULL);
+
     if(bForce || bReDraw || this->NeedScrolled()) {
       this->clear();
       if(scRender) {
-        if(theSetup.m_nRenderMode == eRenderMode_DualLine) {
-          this->DrawTextScrolled(0,pFont->Height(), *scRender, false);
-        } else {
-          int nTop = (theSetup.m_cHeight - pFont->Height())/2;
-          this->DrawTextScrolled(0,nTop<0?0:nTop, *scRender, false);
-        }
-      }
-
-      if(scHeader && theSetup.m_nRenderMode == eRenderMode_DualLine) {
-        int t = 0;
-        if(bAllowCurrentTime && currentTime) {
-          t = pFont->Width(*currentTime);
-          this->DrawText(theSetup.m_cWidth - t, 0, *currentTime);
-          t += 1;
-        }
-        this->DrawTextEclipsed(0, 0, *scHeader, theSetup.m_cWidth - t);
+        int nTop = (this->Height() - pFont->Height())/2;
+        this->DrawTextScrolled(0,nTop<0?0:nTop, *scRender, false);
       }
 
       m_bUpdateScreen = false;
@@ -453,6 +471,61 @@ bool cVFDWatch::RenderScreenSinglePage(bool bReDraw) {
     return false;
 }
 
+/**
+ * Header with current time above the body. Each part is its own layer,
+ * only a part with changed text is drawn again.
+ */
+bool cVFDWatch::RenderScreenDualLine(bool bForce, bool bReDraw, cString* scHeader, cString* scRender, cString* scTime) {
+
+    if(!bForce && !bReDraw && !this->NeedScrolled())
+      return false;
+
+    const int h = pFont->Height();
+    const char* szHeader = scHeader ? (const char*)(*scHeader) : NULL;
+    const char* szTime = (szHeader && scTime) ? (const char*)(*scTime) : NULL;
+    int t = 0;
+    if(szTime)
+      t = pFont->Width(szTime) + 1;
+
+    if(bForce)
+      this->clear();
+
+    // current time, right of the header
+    if(this->LayerChanged(eLayerOverlay, szTime)) {
+      this->ClearLayer(eLayerOverlay);
+      if(szTime) {
+        this->LayerBounds(eLayerOverlay, this->Width() - t, 0, this->Width() - 1, h - 1);
+        this->SelectLayer(eLayerOverlay);
+        this->DrawText(this->Width() - (t - 1), 0, szTime);
+      }
+    }
+
+    // header, left of current time
+    if(this->LayerChanged(eLayerHeader, *cString::sprintf("%d:%s", t, szHeader ? szHeader : ""))) {
+      this->ClearLayer(eLayerHeader);
+      if(szHeader) {
+        this->LayerBounds(eLayerHeader, 0, 0, this->Width() - 1 - t, h - 1);
+        this->SelectLayer(eLayerHeader);
+        this->DrawTextEclipsed(0, 0, szHeader, this->Width() - t);
+      }
+    }
+
+    // body below the header, scrolled text is drawn on each step
+    const char* szRender = scRender ? (const char*)(*scRender) : NULL;
+    if(this->LayerChanged(eLayerBody, szRender) || this->NeedScrolled()) {
+      this->ClearLayer(eLayerBody);
+      if(szRender) {
+        this->LayerBounds(eLayerBody, 0, h, this->Width() - 1, this->Height() - 1);
+        this->SelectLayer(eLayerBody);
+        this->DrawTextScrolled(0, h, szRender, false);
+      }
+    }
+    this->SelectLayer(eLayerBody);
+
+    m_bUpdateScreen = false;
+    return true;
+}
+
 bool cVFDWatch::RenderScreenPages(bool bReDraw, unsigned int& nPage, unsigned int& nMaxPages) {
 
     bool bForce = m_bUpdateScreen;
@@ -480,7 +553,7 @@ bool cVFDWatch::RenderScreenPages(bool bReDraw, unsigned int& nPage, unsigned in
       switch(nPage % nMaxPages) {
         case 0: return RenderText(bForce, bReDraw, chPresentTitle);
         case 1: return RenderText(bForce, bReDraw, chPresentShortTitle);
-        case 2: return RenderText(bForce, bReDraw, currentTime);
+        case 2: return RenderTime(bForce, bReDraw, currentTime);
         case 3: return RenderText(bForce, bReDraw, chName);
       }
 
@@ -498,7 +571,7 @@ bool cVFDWatch::RenderScreenPages(bool bReDraw, unsigned int& nPage, unsigned in
       switch(nPage % nMaxPages) {
         case 0: return RenderText(bForce, bReDraw, replayFolder);
         case 1: return RenderText(bForce, bReDraw, replayTitle);
-        case 2: return RenderText(bForce, bReDraw, replayTime ? replayTime : currentTime);
+        case 2: return RenderTime(bForce, bReDraw, replayTime ? replayTime : currentTime);
         case 3: 
             if(!RenderSpectrumAnalyzer())
                 nPage++; //no span service present
@@ -508,6 +581,21 @@ bool cVFDWatch::RenderScreenPages(bool bReDraw, unsigned int& nPage, unsigned in
     return false;
 }
 
+/**
+ * Clock or replay time, only changed digits are drawn again.
+ */
+bool cVFDWatch::RenderTime(bool bForce, bool bReDraw, cString* scText) {
+
+    if(scText && (bForce || bReDraw)) {
+      int nTop = (this->Height() - pFont->Height())/2;
+      if(this->DrawCells(nTop<0?0:nTop, *scText)) {
+        m_bUpdateScreen = false;
+        return true;
+      }
+    }
+    return RenderText(bForce, bReDraw, scText);
+}
+
 bool cVFDWatch::RenderText(bool bForce, bool bReDraw, cString* scText) {
 
     if(bForce) {
@@ -516,7 +604,7 @@ bool cVFDWatch::RenderText(bool bForce, bool bReDraw, cString* scText) {
     if(bForce || bReDraw || this->NeedScrolled()) {
       this->clear();
       if(scText) {
-        int nTop = (theSetup.m_cHeight - pFont->Height())/2;
+        int nTop = (this->Height() - pFont->Height())/2;
         this->DrawTextScrolled(0,nTop<0?0:nTop,*scText,true);
       }
 
@@ -597,6 +685,7 @@ void cVFDWatch::Replaying(const cControl * Control, const char * szName, const c
 {
     cMutexLooker m(m_Mutex);
     m_bUpdateScreen = true;
+    m_bFrameStale = true;
     if (On)
     {
 #if APIVERSNUM >= 20302
@@ -848,6 +937,7 @@ void cVFDWatch::Channel(int ChannelNumber)
     }
     m_eWatchMode = eLiveTV;
     m_bUpdateScreen = true;
+    m_bFrameStale = true;
     this->RestartScrolled();
 }
 
@@ -1042,6 +1132,7 @@ bool cVFDWatch::SetFont(const char *szFont, bool bTwoLineMode, int nBigFontHeigh
     cMutexLooker m(m_Mutex);
     if(cVFD::SetFont(szFont, bTwoLineMode, nBigFontHeight, nSmallFontHeight)) {
       m_bUpdateScreen = true;
+      m_bFrameStale = true;
       return true;
     }
     return false;
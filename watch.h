@@ -55,6 +55,8 @@ private:
   eWatchMode m_eWatchMode;
 
   bool  m_bUpdateScreen;
+  bool  m_bOsdFrame;      ///< screen below OSD is saved by PushFrame()
+  bool  m_bFrameStale;    ///< saved screen is outdated, redraw after OSD
 
   int   m_nCardIsRecording[MAXDEVICES];
 
@@ -100,8 +102,10 @@ protected:
   bool Program();
   bool Replay();
   bool RenderScreenSinglePage(bool bReDraw);
+  bool RenderScreenDualLine(bool bForce, bool bReDraw, cString* scHeader, cString* scRender, cString* scTime);
   bool RenderScreenPages(bool bReDraw, unsigned int &nPage, unsigned int &nMaxPages);
   bool RenderText(bool bForce, bool bReDraw, cString* scRender);
+  bool RenderTime(bool bForce, bool bReDraw, cString* scRender);
   bool RenderSpectrumAnalyzer();
   eReplayState ReplayMode() const;
   bool ReplayPosition(int &current, int &total, double& dFrameRate) const;
@@ -129,6 +133,9 @@ public:
   virtual bool SetFont(const char *szFont, bool bTwoLineMode, int nBigFontHeight, int nSmallFontHeight);
 
   eIconState ForceIcon(unsigned int nIcon, eIconState nState);
+
+  /** lock of watch thread, hold it to read statistics of displays, engine and font */
+  cMutex& Mutex() { return m_Mutex; }
 };
 
 #endif